@@ -0,0 +1,158 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+
+#include "g2chip_analysis.h"
+#include "g2chip_corpus.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int show_listing = 0;
+static int show_blocks = 0;
+static const char* cache_dir = NULL;
+static size_t cache_hits = 0;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t count_written_pages(const g2chip_analysis_t* analysis) {
+    size_t count = 0;
+    for (size_t page = 0; page < G2CHIP_ANALYSIS_PAGE_COUNT; page++) {
+        count += g2chip_analysis_page_is_written(analysis, (uint16_t)(page * G2CHIP_ANALYSIS_PAGE_SIZE));
+    }
+    return count;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void print_summary(const char* rom_filename, const g2chip_analysis_t* analysis) {
+    printf("%s: size=%zu code=%zu data=%zu instructions=%zu blocks=%zu jumps=%zu calls=%zu skips=%zu indirect=%zu "
+           "invalid=%zu written_pages=%zu/%d unresolved_writes=%zu self_modifying=%zu class=%s\n",
+           rom_filename, analysis->rom_size, analysis->code_size,
+           analysis->rom_size > analysis->code_size ? analysis->rom_size - analysis->code_size : 0,
+           analysis->instruction_count, analysis->block_count, analysis->jump_count, analysis->call_count,
+           analysis->skip_count, analysis->indirect_jump_count, analysis->invalid_count, count_written_pages(analysis),
+           G2CHIP_ANALYSIS_PAGE_COUNT, analysis->unresolved_write_count, analysis->self_modifying_count,
+           g2chip_analysis_classify(analysis));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void print_listing(const uint8_t* rom_data, const g2chip_analysis_t* analysis) {
+    size_t offset = 0;
+    while (offset < analysis->rom_size) {
+        size_t address = G2CHIP_PROGRAM_START_ADDRESS + offset;
+        uint8_t flags = analysis->map[address];
+
+        if (flags & G2CHIP_ANALYSIS_INSTRUCTION) {
+            uint16_t raw = (uint16_t)(rom_data[offset] << 8);
+            if (offset + 1 < analysis->rom_size) {
+                raw |= rom_data[offset + 1];
+            }
+            char mnemonic[32];
+            g2chip_analysis_disassemble(raw, mnemonic, sizeof(mnemonic));
+            printf("  %c%03zX: %04X  %s%s\n", (flags & G2CHIP_ANALYSIS_BLOCK_START) ? '>' : ' ', address, raw,
+                   mnemonic, (flags & G2CHIP_ANALYSIS_WRITTEN) ? "  ; written at runtime" : "");
+            offset += 2;
+            continue;
+        }
+
+        size_t start = offset;
+        while (offset < analysis->rom_size &&
+               (analysis->map[G2CHIP_PROGRAM_START_ADDRESS + offset] & G2CHIP_ANALYSIS_INSTRUCTION) == 0) {
+            offset++;
+        }
+        printf("   %03zX: data %zu B\n", G2CHIP_PROGRAM_START_ADDRESS + start, offset - start);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void print_blocks(const g2chip_analysis_t* analysis) {
+    for (size_t i = 0; i < analysis->block_count; i++) {
+        const g2chip_analysis_block_t* block = &analysis->blocks[i];
+        printf("  block %03X-%03X ->", block->start, block->last);
+        if (block->successor_count == 0) {
+            printf(" exit");
+        }
+        for (uint8_t s = 0; s < block->successor_count; s++) {
+            printf(" %03X", block->successors[s]);
+        }
+        printf("\n");
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int analyze_rom(const g2chip_corpus_rom_t* rom) {
+    g2chip_corpus_info_t info;
+    int loaded = g2chip_corpus_load_info(cache_dir, rom, &info);
+    if (loaded < 0) {
+        printf("Failed to analyze ROM: %s\n", rom->name);
+        return -1;
+    }
+    cache_hits += (size_t)loaded;
+
+    print_summary(rom->name, info.analysis);
+    if (show_listing) {
+        print_listing(rom->data, info.analysis);
+    }
+    if (show_blocks) {
+        print_blocks(info.analysis);
+    }
+
+    g2chip_corpus_free_info(&info);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int analyze_path(const char* path, const char* pack_filename) {
+    g2chip_corpus_t* corpus = g2chip_corpus_open(path);
+    if (corpus == NULL) {
+        printf("Failed to open ROM corpus: %s\n", path);
+        return -1;
+    }
+
+    int result = 0;
+    for (size_t i = 0; i < g2chip_corpus_count(corpus); i++) {
+        if (analyze_rom(g2chip_corpus_get(corpus, i)) != 0) {
+            result = -1;
+        }
+    }
+    if (g2chip_corpus_duplicate_count(corpus) > 0) {
+        printf("%s: skipped %zu duplicate ROMs\n", path, g2chip_corpus_duplicate_count(corpus));
+    }
+    if (pack_filename != NULL && g2chip_corpus_write_pack(corpus, pack_filename) != 0) {
+        printf("Failed to write pack file: %s\n", pack_filename);
+        result = -1;
+    }
+
+    g2chip_corpus_close(corpus);
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[]) {
+    const char* pack_filename = NULL;
+    int first_rom = 1;
+    for (; first_rom < argc && argv[first_rom][0] == '-'; first_rom++) {
+        if (strcmp(argv[first_rom], "-l") == 0) {
+            show_listing = 1;
+        } else if (strcmp(argv[first_rom], "-b") == 0) {
+            show_blocks = 1;
+        } else if (strcmp(argv[first_rom], "-c") == 0 && first_rom + 1 < argc) {
+            cache_dir = argv[++first_rom];
+        } else if (strcmp(argv[first_rom], "-o") == 0 && first_rom + 1 < argc) {
+            pack_filename = argv[++first_rom];
+        } else {
+            first_rom = argc;
+        }
+    }
+    if (first_rom >= argc || (pack_filename != NULL && argc - first_rom != 1)) {
+        printf("Usage: %s [-l] [-b] [-c cache_dir] [-o pack_file] <ROM file, directory or pack>...\n", argv[0]);
+        printf("  -l  print a disassembly listing with code and data regions\n");
+        printf("  -b  print the basic blocks of the control-flow graph\n");
+        printf("  -c  reuse and store per-ROM analysis in cache_dir, keyed by content hash\n");
+        printf("  -o  write the deduplicated ROMs of a single input into a pack file\n");
+        return -1;
+    }
+
+    int result = 0;
+    for (int i = first_rom; i < argc; i++) {
+        if (analyze_path(argv[i], pack_filename) != 0) {
+            result = -1;
+        }
+    }
+    if (cache_dir != NULL) {
+        printf("cache: %zu hits in %s\n", cache_hits, cache_dir);
+    }
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
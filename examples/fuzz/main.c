@@ -0,0 +1,155 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "g2chip.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*
+ * Fuzzer input layout:
+ *   [0]          number of key script frames N
+ *   [1 .. 2N]    N little-endian 16-bit keypad masks (bit K set = key K pressed)
+ *   [2N+1 .. ]   ROM image loaded at G2CHIP_PROGRAM_START_ADDRESS
+ *
+ * The key script advances every FUZZ_STEPS_PER_KEY_FRAME steps and on every FX0A and wraps around when exhausted.
+ */
+#define FUZZ_MAX_STEPS 8192
+#define FUZZ_STEPS_PER_KEY_FRAME 64
+#define FUZZ_KEY_SCRIPT_MASK_SIZE 2
+/*--------------------------------------------------------------------------------------------------------------------*/
+static g2chip_t* chip = NULL;
+static const uint8_t* key_script = NULL;
+static size_t key_script_frames = 0;
+static size_t key_frame = 0;
+static uint32_t fake_time_ms = 0;
+static uint8_t random_state = 0;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint16_t current_keypad(void) {
+    if (key_script_frames == 0) {
+        return 0;
+    }
+    const uint8_t* mask = &key_script[(key_frame % key_script_frames) * FUZZ_KEY_SCRIPT_MASK_SIZE];
+    return (uint16_t)(mask[0] | (mask[1] << 8));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint32_t get_time_ms_impl(void) {
+    return fake_time_ms;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t key_is_pressed_impl(uint8_t key) {
+    return (current_keypad() >> (key & 0x0F)) & 0x01;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t key_wait_press_impl(void) {
+    uint16_t keypad = current_keypad();
+    key_frame++;
+    for (uint8_t key = 0; key < 16; key++) {
+        if (keypad & (1 << key)) {
+            return key;
+        }
+    }
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t get_random_byte_impl(void) {
+    // Full-period 8-bit LCG keeps runs reproducible for a given input
+    random_state = (uint8_t)(random_state * 109 + 89);
+    return random_state;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void debug_log_impl(const char* message) {
+    (void)message;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static g2chip_t* get_chip(void) {
+    if (chip == NULL) {
+        g2chip_config_t config = {0};
+        config.get_time_ms = get_time_ms_impl;
+        config.key_is_pressed = key_is_pressed_impl;
+        config.key_wait_press = key_wait_press_impl;
+        config.get_random_byte = get_random_byte_impl;
+        config.debug_log = debug_log_impl;
+        chip = g2chip_create(&config);
+    }
+    return chip;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size < 1) {
+        return 0;
+    }
+    size_t script_size = (size_t)data[0] * FUZZ_KEY_SCRIPT_MASK_SIZE;
+    if (size <= 1 + script_size) {
+        return 0;
+    }
+    const uint8_t* rom_data = data + 1 + script_size;
+    size_t rom_size = size - 1 - script_size;
+    if (rom_size > G2CHIP_MAX_ROM_SIZE) {
+        rom_size = G2CHIP_MAX_ROM_SIZE;
+    }
+
+    g2chip_t* instance = get_chip();
+    if (instance == NULL) {
+        return 0;
+    }
+
+    key_script = data + 1;
+    key_script_frames = data[0];
+    key_frame = 0;
+    fake_time_ms = 0;
+    random_state = 0;
+
+    // One long-lived instance reset per input is far cheaper than a create/destroy cycle
+    g2chip_reset(instance);
+    if (g2chip_load_rom(instance, rom_data, rom_size) != 0) {
+        return 0;
+    }
+
+    for (uint32_t step = 0; step < FUZZ_MAX_STEPS; step++) {
+        if (step != 0 && (step % FUZZ_STEPS_PER_KEY_FRAME) == 0) {
+            key_frame++;
+        }
+        fake_time_ms++;
+        g2chip_step(instance);
+    }
+
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+#ifdef G2CHIP_FUZZ_STANDALONE
+/* Replays corpus files through the harness on toolchains without libFuzzer (e.g. GCC with sanitizers) */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <input file>...\n", argv[0]);
+        return -1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        FILE* input_file = fopen(argv[i], "rb");
+        if (input_file == NULL) {
+            printf("Failed to open input file: %s\n", argv[i]);
+            return -1;
+        }
+        fseek(input_file, 0, SEEK_END);
+        long input_size = ftell(input_file);
+        fseek(input_file, 0, SEEK_SET);
+        uint8_t* input_data = (uint8_t*)malloc(input_size > 0 ? (size_t)input_size : 1);
+        if (input_data == NULL) {
+            printf("Failed to allocate memory for input\n");
+            fclose(input_file);
+            return -1;
+        }
+        size_t read_size = fread(input_data, 1, (size_t)input_size, input_file);
+        fclose(input_file);
+
+        LLVMFuzzerTestOneInput(input_data, read_size);
+        printf("Executed '%s' (%zu B)\n", argv[i], read_size);
+        free(input_data);
+    }
+
+    g2chip_destroy(chip);
+    return 0;
+}
+#endif
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,158 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "g2chip.h"
+#include "g2chip_capture.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define DEFAULT_FRAME_COUNT 600
+#define DEFAULT_SCALE 4
+#define INSTRUCTIONS_PER_FRAME 11
+#define FRAME_PERIOD_US 16667
+#define GIF_FRAME_DELAY_CS 2
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t emulated_time_us = 0;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint32_t get_time_ms_impl(void) {
+    return (uint32_t)(emulated_time_us / 1000);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t get_random_byte_impl(void) {
+    return (uint8_t)(rand() % 256);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t* read_file(const char* filename, size_t* size) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        printf("Failed to open file: %s\n", filename);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (file_size <= 0) {
+        printf("File is empty: %s\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    uint8_t* data = (uint8_t*)calloc((size_t)file_size, sizeof(uint8_t));
+    if (data == NULL) {
+        printf("Failed to allocate memory for %s\n", filename);
+        fclose(file);
+        return NULL;
+    }
+    *size = fread(data, 1, (size_t)file_size, file);
+    fclose(file);
+    return data;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void print_usage(const char* program) {
+    printf("Usage: %s [-f frames] [-s scale] [-p png_prefix] [-g gif_file] <ROM file> <capture file>\n", program);
+    printf("  -f  number of 60 Hz frames to run (default %d)\n", DEFAULT_FRAME_COUNT);
+    printf("  -s  pixel scale for PNG/GIF export (default %d)\n", DEFAULT_SCALE);
+    printf("  -p  also export every frame as <png_prefix>NNNNN.png\n");
+    printf("  -g  also export an animated GIF\n");
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[]) {
+    long frame_count = DEFAULT_FRAME_COUNT;
+    long scale = DEFAULT_SCALE;
+    const char* png_prefix = NULL;
+    const char* gif_filename = NULL;
+
+    int arg = 1;
+    for (; arg + 1 < argc && argv[arg][0] == '-'; arg += 2) {
+        if (strcmp(argv[arg], "-f") == 0) {
+            frame_count = strtol(argv[arg + 1], NULL, 10);
+        } else if (strcmp(argv[arg], "-s") == 0) {
+            scale = strtol(argv[arg + 1], NULL, 10);
+        } else if (strcmp(argv[arg], "-p") == 0) {
+            png_prefix = argv[arg + 1];
+        } else if (strcmp(argv[arg], "-g") == 0) {
+            gif_filename = argv[arg + 1];
+        } else {
+            break;
+        }
+    }
+    if (argc - arg != 2 || frame_count <= 0 || scale <= 0 || scale > 16) {
+        print_usage(argv[0]);
+        return -1;
+    }
+    const char* rom_filename = argv[arg];
+    const char* capture_filename = argv[arg + 1];
+
+    size_t rom_size = 0;
+    uint8_t* rom_data = read_file(rom_filename, &rom_size);
+    if (rom_data == NULL) {
+        return -1;
+    }
+
+    g2chip_config_t config = {0};
+    config.get_time_ms = get_time_ms_impl;
+    config.get_random_byte = get_random_byte_impl;
+
+    // Frames stream straight into the capture file, so long runs don't grow the heap
+    FILE* capture_file = fopen(capture_filename, "wb");
+    if (capture_file == NULL) {
+        printf("Failed to open capture file: %s\n", capture_filename);
+        free(rom_data);
+        return -1;
+    }
+
+    g2chip_t* chip = g2chip_create(&config);
+    g2chip_capture_t* capture = g2chip_capture_create_file(capture_file);
+    if (chip == NULL || capture == NULL || g2chip_load_rom(chip, rom_data, rom_size) != 0) {
+        printf("Failed to set up headless G2Chip instance\n");
+        g2chip_capture_destroy(capture);
+        g2chip_destroy(chip);
+        fclose(capture_file);
+        free(rom_data);
+        return -1;
+    }
+    free(rom_data);
+
+    for (long frame = 0; frame < frame_count; frame++) {
+        for (int i = 0; i < INSTRUCTIONS_PER_FRAME; i++) {
+            g2chip_step(chip);
+        }
+        emulated_time_us += FRAME_PERIOD_US;
+        g2chip_capture_frame(capture, g2chip_get_display(chip));
+    }
+    g2chip_destroy(chip);
+
+    int result = g2chip_capture_flush(capture);
+    long capture_size = ftell(capture_file);
+    printf("Captured %zu frames into %ld B\n", g2chip_capture_frame_count(capture), capture_size);
+    g2chip_capture_destroy(capture);
+    if (fclose(capture_file) != 0 || result != 0) {
+        printf("Failed to write capture file: %s\n", capture_filename);
+        return -1;
+    }
+    if (png_prefix == NULL && gif_filename == NULL) {
+        return 0;
+    }
+
+    // The exporters decode from memory, so read the finished stream back
+    size_t stream_size = 0;
+    uint8_t* stream = read_file(capture_filename, &stream_size);
+    if (stream == NULL) {
+        return -1;
+    }
+
+    if (png_prefix != NULL && g2chip_capture_export_png(stream, stream_size, png_prefix, (uint8_t)scale) != 0) {
+        printf("Failed to export PNG frames: %s\n", png_prefix);
+        result = -1;
+    }
+    if (gif_filename != NULL &&
+        g2chip_capture_export_gif(stream, stream_size, gif_filename, (uint8_t)scale, GIF_FRAME_DELAY_CS) != 0) {
+        printf("Failed to export GIF: %s\n", gif_filename);
+        result = -1;
+    }
+
+    free(stream);
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -6,15 +6,13 @@
 #include <stdlib.h>
 #include <time.h>
 
-#include "g2chip.h"
+#include "g2chip_corpus.h"
+#include "g2chip_runner.h"
 /*--------------------------------------------------------------------------------------------------------------------*/
 static SDL_Window* window = NULL;
 static SDL_Renderer* renderer = NULL;
 static SDL_Texture* texture = NULL;
 static uint32_t display_buffer[G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT];
-static uint8_t key_state[16] = {0};
-static uint8_t waiting_for_key = 0;
-static uint8_t last_pressed_key = 0;
 /*--------------------------------------------------------------------------------------------------------------------*/
 #define DISPLAY_SCALE 10
 /*--------------------------------------------------------------------------------------------------------------------*/
@@ -86,7 +84,7 @@ static int init_sdl_display(void) {
         return -1;
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (renderer == NULL) {
         printf("Renderer could not be created! SDL_Error: %s\n",
                SDL_GetError());
@@ -114,60 +112,19 @@ static void cleanup_sdl_display(void) {
     SDL_Quit();
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
-static void display_clear_impl(void) {
+static void display_update_frame(const uint8_t* frame) {
     for (int i = 0; i < G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT; i++) {
-        display_buffer[i] = 0x000000FF;  // Black with full alpha
+        display_buffer[i] = frame[i] ? 0xFFFFFFFF : 0x000000FF;  // White or Black
     }
-}
-/*--------------------------------------------------------------------------------------------------------------------*/
-static void display_draw_pixel_impl(uint8_t x, uint8_t y, uint8_t state) {
-    if (x >= G2CHIP_DISPLAY_WIDTH || y >= G2CHIP_DISPLAY_HEIGHT)
-        return;
-
-    int index = y * G2CHIP_DISPLAY_WIDTH + x;
-    display_buffer[index] = state ? 0xFFFFFFFF : 0x000000FF;  // White or Black
-}
-/*--------------------------------------------------------------------------------------------------------------------*/
-static void display_refresh_impl(void) {
     SDL_UpdateTexture(texture, NULL, display_buffer,
                       G2CHIP_DISPLAY_WIDTH * sizeof(uint32_t));
-
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void display_present(void) {
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, NULL, NULL);
-    SDL_RenderPresent(renderer);
-}
-/*--------------------------------------------------------------------------------------------------------------------*/
-static uint8_t key_is_pressed_impl(uint8_t key) {
-    if (key >= 16)
-        return 0;
-    return key_state[key];
-}
-/*--------------------------------------------------------------------------------------------------------------------*/
-
-static uint8_t key_wait_press_impl(void) {
-    waiting_for_key = 1;
-
-    SDL_Event event;
-    while (waiting_for_key) {
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_QUIT) {
-                waiting_for_key = 0;
-                return 0;
-            }
-
-            if (event.type == SDL_KEYDOWN) {
-                uint8_t chip8_key = sdl_key_to_chip8_key(event.key.keysym.sym);
-                if (chip8_key != 0xFF) {
-                    waiting_for_key = 0;
-                    return chip8_key;
-                }
-            }
-        }
-        SDL_Delay(10);
-    }
-
-    return 0;
+    SDL_RenderPresent(renderer);  // Blocks until vsync
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
 static void debug_log_impl(const char* message) {
@@ -187,49 +144,36 @@ int main(int argc, char* argv[]) {
         return -1;
     }
 
-    const char* rom_filename = argv[1];
-    FILE* rom_file = fopen(rom_filename, "rb");
-    if (rom_file == NULL) {
-        printf("Failed to open ROM file: %s\n", rom_filename);
-        return -1;
-    }
-    fseek(rom_file, 0, SEEK_END);
-    long rom_size = ftell(rom_file);
-    printf("Loaded ROM '%s' size: %ld B\n", rom_filename, rom_size);
-    fseek(rom_file, 0, SEEK_SET);
-    uint8_t* rom_data = (uint8_t*)calloc(rom_size, sizeof(uint8_t));
-    if (rom_data == NULL) {
-        printf("Failed to allocate memory for ROM\n");
-        fclose(rom_file);
+    // A directory or pack works too; the first ROM in it is run
+    g2chip_corpus_t* corpus = g2chip_corpus_open(argv[1]);
+    const g2chip_corpus_rom_t* rom = g2chip_corpus_get(corpus, 0);
+    if (rom == NULL) {
+        printf("Failed to open ROM file: %s\n", argv[1]);
+        g2chip_corpus_close(corpus);
+        cleanup_sdl_display();
         return -1;
     }
-    fread(rom_data, 1, rom_size, rom_file);
-    fclose(rom_file);
-
-    g2chip_config_t config = {0};
-    config.get_time_ms = get_time_ms_impl;
-    config.display_clear = display_clear_impl;
-    config.display_draw_pixel = display_draw_pixel_impl;
-    config.display_refresh = display_refresh_impl;
-    config.key_is_pressed = key_is_pressed_impl;
-    config.key_wait_press = key_wait_press_impl;
-    config.get_random_byte = get_random_byte_impl;
-    config.sound_beep_start = NULL;  // Implement as needed
-    config.sound_beep_stop = NULL;   // Implement as needed
-    config.debug_log = debug_log_impl;
-
-    g2chip_t* chip = g2chip_create(&config);
-    if (chip == NULL) {
-        printf("Failed to create G2Chip instance\n");
-        free(rom_data);
+    printf("Loaded ROM '%s' size: %zu B\n", rom->name, rom->size);
+
+    // The emulation thread invokes these callbacks; keys and frames go through the runner
+    g2chip_runner_config_t config = {0};
+    config.chip.get_time_ms = get_time_ms_impl;
+    config.chip.get_random_byte = get_random_byte_impl;
+    config.chip.sound_beep_start = NULL;  // Implement as needed
+    config.chip.sound_beep_stop = NULL;   // Implement as needed
+    config.chip.debug_log = debug_log_impl;
+
+    g2chip_runner_t* runner = g2chip_runner_create(&config, rom->data, rom->size);
+    g2chip_corpus_close(corpus);
+    if (runner == NULL) {
+        printf("Failed to create G2Chip runner\n");
         cleanup_sdl_display();
         return -1;
     }
 
-    if (g2chip_load_rom(chip, rom_data, rom_size) != 0) {
-        printf("Failed to load ROM into G2Chip\n");
-        g2chip_destroy(chip);
-        free(rom_data);
+    if (g2chip_runner_start(runner) != 0) {
+        printf("Failed to start G2Chip emulation thread\n");
+        g2chip_runner_destroy(runner);
         cleanup_sdl_display();
         return -1;
     }
@@ -240,27 +184,23 @@ int main(int argc, char* argv[]) {
         while (SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 running = 0;
-            } else if (event.type == SDL_KEYDOWN) {
+            } else if ((event.type == SDL_KEYDOWN && !event.key.repeat) || event.type == SDL_KEYUP) {
                 uint8_t chip8_key = sdl_key_to_chip8_key(event.key.keysym.sym);
                 if (chip8_key != 0xFF) {
-                    key_state[chip8_key] = 1;
-                    last_pressed_key = chip8_key;
-                }
-            } else if (event.type == SDL_KEYUP) {
-                uint8_t chip8_key = sdl_key_to_chip8_key(event.key.keysym.sym);
-                if (chip8_key != 0xFF) {
-                    key_state[chip8_key] = 0;
+                    g2chip_runner_set_key(runner, chip8_key, event.type == SDL_KEYDOWN);
                 }
             }
         }
 
-        g2chip_step(chip);
-
-        SDL_Delay(1);  // Basic timing control
+        const uint8_t* frame = NULL;
+        if (g2chip_runner_acquire_frame(runner, &frame) == 1) {
+            display_update_frame(frame);
+        }
+        display_present();
     }
 
-    free(rom_data);
-    g2chip_destroy(chip);
+    g2chip_runner_destroy(runner);
+    cleanup_sdl_display();
     return 0;
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
\ No newline at end of file
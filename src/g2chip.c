@@ -9,6 +9,16 @@
 #define G2CHIP_REGISTER_INDEX_LAST (G2CHIP_REGISTER_COUNT - 1)
 #define G2CHIP_FONT_START_ADDRESS 0x50
 #define G2CHIP_FONT_SIZE (16 * 5)
+#define G2CHIP_PAGE_SIZE 256
+#define G2CHIP_MEMORY_GUARD_SIZE G2CHIP_PAGE_SIZE
+#define G2CHIP_MEMORY_TOTAL_SIZE (G2CHIP_MEMORY_SIZE + G2CHIP_MEMORY_GUARD_SIZE)
+#define G2CHIP_PAGE_COUNT (G2CHIP_MEMORY_TOTAL_SIZE / G2CHIP_PAGE_SIZE)
+#define G2CHIP_DIRTY_WORD_BITS 32
+#define G2CHIP_DIRTY_WORD_COUNT ((G2CHIP_PAGE_COUNT + G2CHIP_DIRTY_WORD_BITS - 1) / G2CHIP_DIRTY_WORD_BITS)
+/*--------------------------------------------------------------------------------------------------------------------*/
+_Static_assert((G2CHIP_MEMORY_SIZE & G2CHIP_ADDRESS_MASK) == 0, "G2CHIP_MEMORY_SIZE must be a power of two");
+_Static_assert(G2CHIP_MEMORY_SIZE >= 4096 && G2CHIP_MEMORY_SIZE <= 65536,
+               "G2CHIP_MEMORY_SIZE must be between 4 KB and 64 KB");
 /*--------------------------------------------------------------------------------------------------------------------*/
 typedef struct g2chip_instruction {
     uint16_t raw;
@@ -25,8 +35,13 @@ typedef void (*instruction_handler_t)(g2chip_t* chip,
 /*--------------------------------------------------------------------------------------------------------------------*/
 typedef struct g2chip {
     g2chip_config_t config;
-    uint8_t memory[G2CHIP_MEMORY_SIZE];
+    uint8_t memory[G2CHIP_MEMORY_TOTAL_SIZE];          /**< Address space followed by the guard region */
+    uint8_t pristine_memory[G2CHIP_MEMORY_TOTAL_SIZE]; /**< Font and ROM image restored on reset */
+    uint32_t address_wrap_mask; /**< Applied after adding an offset to a masked base address */
+    uint32_t dirty_pages[G2CHIP_DIRTY_WORD_COUNT]; /**< Pages of memory written since the last reset */
+    size_t rom_size;
     uint8_t display[G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT];
+    uint8_t display_dirty;
     uint8_t V[G2CHIP_REGISTER_COUNT];
     uint16_t stack[G2CHIP_STACK_SIZE];
     uint32_t last_time_ms;
@@ -35,6 +50,8 @@ typedef struct g2chip {
     uint8_t delay_timer;
     uint8_t sound_timer;
     uint8_t sp;
+    uint16_t keypad;      /**< Key state set by g2chip_set_keypad(), or last polled through key_is_pressed by FX0A */
+    uint16_t key_presses; /**< Keys pressed in keypad since the last FX0A took one */
 } g2chip_t;
 /*--------------------------------------------------------------------------------------------------------------------*/
 static void instruction_handler_opcode_0(g2chip_t* chip,
@@ -115,6 +132,51 @@ static const uint8_t g2chip_font_data[16 * 5] = {
     // F
     0xF0, 0x80, 0xF0, 0x80, 0x80};
 /*--------------------------------------------------------------------------------------------------------------------*/
+static void load_font_data(g2chip_t* chip) {
+    memcpy(&chip->pristine_memory[G2CHIP_FONT_START_ADDRESS], g2chip_font_data, G2CHIP_FONT_SIZE);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void mark_page_dirty(g2chip_t* chip, size_t address) {
+    size_t page = address / G2CHIP_PAGE_SIZE;
+    chip->dirty_pages[page / G2CHIP_DIRTY_WORD_BITS] |= 1UL << (page % G2CHIP_DIRTY_WORD_BITS);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void mark_range_dirty(g2chip_t* chip, size_t start, size_t end) {
+    for (size_t address = start; address < end; address += G2CHIP_PAGE_SIZE) {
+        mark_page_dirty(chip, address);
+    }
+    if (end > start) {
+        mark_page_dirty(chip, end - 1);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void restore_dirty_pages(g2chip_t* chip) {
+    for (size_t word = 0; word < G2CHIP_DIRTY_WORD_COUNT; word++) {
+        uint32_t dirty = chip->dirty_pages[word];
+        for (size_t bit = 0; dirty != 0; bit++, dirty >>= 1) {
+            if (dirty & 1) {
+                size_t offset = (word * G2CHIP_DIRTY_WORD_BITS + bit) * G2CHIP_PAGE_SIZE;
+                memcpy(&chip->memory[offset], &chip->pristine_memory[offset], G2CHIP_PAGE_SIZE);
+            }
+        }
+        chip->dirty_pages[word] = 0;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*
+ * Every access is a masked base plus a small offset (at most 15), masked again with the quirk-dependent wrap mask:
+ * G2CHIP_ADDRESS_MASK wraps to the start of memory, a wider mask lets the offset run into the guard region.
+ * Either way the result stays inside memory[] without a branch.
+ */
+static inline uint32_t memory_address(const g2chip_t* chip, uint32_t base, uint32_t offset) {
+    return ((base & G2CHIP_ADDRESS_MASK) + offset) & chip->address_wrap_mask;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void memory_write(g2chip_t* chip, uint32_t address, uint8_t value) {
+    chip->memory[address] = value;
+    mark_page_dirty(chip, address);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
 g2chip_t* g2chip_create(const g2chip_config_t* config) {
     if (config == NULL) {
         return NULL;
@@ -126,6 +188,14 @@ g2chip_t* g2chip_create(const g2chip_config_t* config) {
     }
 
     chip->config = *config;
+    if (chip->config.quirks.memory_wrap == G2CHIP_MEMORY_WRAP_GUARD) {
+        chip->address_wrap_mask = (2 * G2CHIP_MEMORY_SIZE) - 1;
+    } else {
+        chip->address_wrap_mask = G2CHIP_ADDRESS_MASK;
+    }
+    load_font_data(chip);
+    mark_range_dirty(chip, 0, G2CHIP_MEMORY_TOTAL_SIZE);
+    chip->display_dirty = 1;
     g2chip_reset(chip);
 
     return chip;
@@ -143,34 +213,40 @@ int g2chip_load_rom(g2chip_t* chip, const uint8_t* rom_data, size_t size) {
         return -1;
     }
 
-    for (size_t i = 0; i < size; i++) {
-        chip->memory[G2CHIP_PROGRAM_START_ADDRESS + i] = rom_data[i];
+    memcpy(&chip->pristine_memory[G2CHIP_PROGRAM_START_ADDRESS], rom_data, size);
+    memcpy(&chip->memory[G2CHIP_PROGRAM_START_ADDRESS], rom_data, size);
+
+    if (chip->rom_size > size) {
+        // Drop the tail of a longer previous ROM so no byte of it outlives the load
+        size_t tail_start = G2CHIP_PROGRAM_START_ADDRESS + size;
+        size_t tail_end = G2CHIP_PROGRAM_START_ADDRESS + chip->rom_size;
+        memset(&chip->pristine_memory[tail_start], 0, tail_end - tail_start);
+        memset(&chip->memory[tail_start], 0, tail_end - tail_start);
+        mark_range_dirty(chip, tail_start, tail_end);
     }
+    chip->rom_size = size;
 
     return 0;
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
-static void load_font_data(g2chip_t* chip) {
-    for (size_t i = 0; i < G2CHIP_FONT_SIZE; i++) {
-        chip->memory[G2CHIP_FONT_START_ADDRESS + i] = g2chip_font_data[i];
-    }
-}
-/*--------------------------------------------------------------------------------------------------------------------*/
 void g2chip_reset(g2chip_t* chip) {
     if (chip == NULL) {
         return;
     }
 
-    memset(chip->memory, 0, G2CHIP_MEMORY_SIZE);
-    load_font_data(chip);
+    restore_dirty_pages(chip);
 
     memset(chip->V, 0, sizeof(chip->V));
     memset(chip->stack, 0, sizeof(chip->stack));
     chip->I = 0;
     chip->pc = G2CHIP_PROGRAM_START_ADDRESS;
     chip->sp = 0;
+    chip->key_presses = 0;
 
-    memset(chip->display, 0, sizeof(chip->display));
+    if (chip->display_dirty) {
+        memset(chip->display, 0, sizeof(chip->display));
+        chip->display_dirty = 0;
+    }
     if (chip->config.display_clear) {
         chip->config.display_clear();
     }
@@ -212,6 +288,7 @@ static void update_timers(g2chip_t* chip) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 static void instruction_clear_display(g2chip_t* chip) {
     memset(chip->display, 0, sizeof(chip->display));
+    chip->display_dirty = 0;
     if (chip->config.display_clear) {
         chip->config.display_clear();
     }
@@ -236,9 +313,10 @@ static void instruction_jump_to_address(g2chip_t* chip, uint16_t address) {
 /*--------------------------------------------------------------------------------------------------------------------*/
 static void draw_sprite(g2chip_t* chip, uint8_t x, uint8_t y, uint8_t height) {
     chip->V[G2CHIP_REGISTER_INDEX_LAST] = 0;  // Clear collision flag
+    chip->display_dirty = 1;
 
     for (int row = 0; row < height; row++) {
-        uint8_t sprite_byte = chip->memory[chip->I + row];
+        uint8_t sprite_byte = chip->memory[memory_address(chip, chip->I, row)];
 
         for (int col = 0; col < 8; col++) {
             if ((sprite_byte & (0x80 >> col)) != 0) {
@@ -269,7 +347,7 @@ static void draw_sprite(g2chip_t* chip, uint8_t x, uint8_t y, uint8_t height) {
 static g2chip_instruction_t fetch_instruction(g2chip_t* chip) {
     g2chip_instruction_t instr;
     memset(&instr, 0, sizeof(instr));
-    instr.raw = (chip->memory[chip->pc] << 8) | chip->memory[chip->pc + 1];
+    instr.raw = (chip->memory[chip->pc & G2CHIP_ADDRESS_MASK] << 8) | chip->memory[memory_address(chip, chip->pc, 1)];
     instr.opcode = (instr.raw & 0xF000) >> 12;
     instr.x = (instr.raw & 0x0F00) >> 8;
     instr.y = (instr.raw & 0x00F0) >> 4;
@@ -308,6 +386,14 @@ static void instruction_handler_opcode_1(g2chip_t* chip,
 /*--------------------------------------------------------------------------------------------------------------------*/
 static void instruction_handler_opcode_2(g2chip_t* chip,
                                          g2chip_instruction_t* instr) {
+    if (chip->sp >= G2CHIP_STACK_SIZE) {
+        if (chip->config.debug_log) {
+            char buffer[64];
+            sprintf(buffer, "Stack overflow on CALL for pc=%04X", chip->pc);
+            chip->config.debug_log(buffer);
+        }
+        return;
+    }
     chip->stack[chip->sp] = chip->pc;
     chip->sp++;
     instruction_jump_to_address(chip, instr->nnn);
@@ -425,16 +511,45 @@ static void instruction_handler_opcode_D(g2chip_t* chip,
     draw_sprite(chip, chip->V[instr->x], chip->V[instr->y], instr->n);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t key_is_pressed(g2chip_t* chip, uint8_t key) {
+    if (chip->config.key_is_pressed) {
+        return chip->config.key_is_pressed(key);
+    }
+    return (chip->keypad >> (key & 0x0F)) & 0x01;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void update_keypad(g2chip_t* chip, uint16_t keypad) {
+    chip->key_presses |= keypad & (uint16_t)~chip->keypad;
+    chip->keypad = keypad;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void poll_keypad(g2chip_t* chip) {
+    uint16_t keypad = 0;
+    for (uint8_t key = 0; key < 16; key++) {
+        if (chip->config.key_is_pressed(key)) {
+            keypad |= (uint16_t)(1 << key);
+        }
+    }
+    update_keypad(chip, keypad);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t lowest_pressed_key(uint16_t keypad) {
+    uint8_t key = 0;
+    while ((keypad & 0x01) == 0) {
+        keypad >>= 1;
+        key++;
+    }
+    return key;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
 static void instruction_handler_opcode_E(g2chip_t* chip,
                                          g2chip_instruction_t* instr) {
     if (instr->nn == 0x9E) {
-        if (chip->config.key_is_pressed &&
-            chip->config.key_is_pressed(chip->V[instr->x])) {
+        if (key_is_pressed(chip, chip->V[instr->x])) {
             chip->pc += 2;
         }
     } else if (instr->nn == 0xA1) {
-        if (chip->config.key_is_pressed &&
-            !chip->config.key_is_pressed(chip->V[instr->x])) {
+        if (!key_is_pressed(chip, chip->V[instr->x])) {
             chip->pc += 2;
         }
     } else {
@@ -451,6 +566,17 @@ static void instruction_handler_opcode_F(g2chip_t* chip,
         case 0x0A:
             if (chip->config.key_wait_press) {
                 chip->V[instr->x] = chip->config.key_wait_press();
+                break;
+            }
+            if (chip->config.key_is_pressed) {
+                poll_keypad(chip);  // Presses only show up while FX0A polls, a tap between two polls is missed
+            }
+            if (chip->key_presses != 0) {
+                // Like key_wait_press, only a new press counts: a key still held from the last FX0A does not
+                chip->V[instr->x] = lowest_pressed_key(chip->key_presses);
+                chip->key_presses = 0;
+            } else {
+                chip->pc -= 2;  // Re-execute until the keypad reports a press
             }
             break;
         case 0x15:
@@ -478,18 +604,18 @@ static void instruction_handler_opcode_F(g2chip_t* chip,
             }
             break;
         case 0x33:
-            chip->memory[chip->I] = chip->V[instr->x] / 100;
-            chip->memory[chip->I + 1] = (chip->V[instr->x] / 10) % 10;
-            chip->memory[chip->I + 2] = chip->V[instr->x] % 10;
+            memory_write(chip, memory_address(chip, chip->I, 0), chip->V[instr->x] / 100);
+            memory_write(chip, memory_address(chip, chip->I, 1), (chip->V[instr->x] / 10) % 10);
+            memory_write(chip, memory_address(chip, chip->I, 2), chip->V[instr->x] % 10);
             break;
         case 0x55:
             for (uint8_t i = 0; i <= instr->x; i++) {
-                chip->memory[chip->I + i] = chip->V[i];
+                memory_write(chip, memory_address(chip, chip->I, i), chip->V[i]);
             }
             break;
         case 0x65:
             for (uint8_t i = 0; i <= instr->x; i++) {
-                chip->V[i] = chip->memory[chip->I + i];
+                chip->V[i] = chip->memory[memory_address(chip, chip->I, i)];
             }
             break;
         default:
@@ -512,3 +638,16 @@ void g2chip_step(g2chip_t* chip) {
     execute_step(chip);
 }
 /*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_set_keypad(g2chip_t* chip, uint16_t keypad) {
+    if (chip != NULL) {
+        update_keypad(chip, keypad);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+const uint8_t* g2chip_get_display(const g2chip_t* chip) {
+    if (chip == NULL) {
+        return NULL;
+    }
+    return chip->display;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -7,7 +7,10 @@
 #include <stddef.h>
 #include <stdint.h>
 /*--------------------------------------------------------------------------------------------------------------------*/
-#define G2CHIP_MEMORY_SIZE 4096
+#ifndef G2CHIP_MEMORY_SIZE
+#define G2CHIP_MEMORY_SIZE 4096 /**< Power of two between 4 KB and 64 KB */
+#endif
+#define G2CHIP_ADDRESS_MASK (G2CHIP_MEMORY_SIZE - 1)
 #define G2CHIP_DISPLAY_WIDTH 64
 #define G2CHIP_DISPLAY_HEIGHT 32
 #define G2CHIP_REGISTER_COUNT 16
@@ -17,13 +20,22 @@
 /*--------------------------------------------------------------------------------------------------------------------*/
 typedef struct g2chip g2chip_t;
 /*--------------------------------------------------------------------------------------------------------------------*/
+typedef enum g2chip_memory_wrap {
+    G2CHIP_MEMORY_WRAP_AROUND = 0, /**< I + offset past the end wraps to the start of memory */
+    G2CHIP_MEMORY_WRAP_GUARD,      /**< I + offset past the end lands in a scratch guard region */
+} g2chip_memory_wrap_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_quirks {
+    g2chip_memory_wrap_t memory_wrap;
+} g2chip_quirks_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
 typedef struct g2chip_config {
     uint32_t (*get_time_ms)(
         void); /**< Function pointer to get current time in milliseconds */
     void (*display_clear)(void);
     void (*display_draw_pixel)(uint8_t x, uint8_t y, uint8_t state);
     void (*display_refresh)(void);
-    uint8_t (*key_is_pressed)(uint8_t key); /**< Check if key 0-F is pressed */
+    uint8_t (*key_is_pressed)(uint8_t key); /**< Check if key 0-F is pressed; without key_wait_press FX0A polls it */
     uint8_t (*key_wait_press)(
         void); /**< Wait for any key press, return key value */
 
@@ -34,6 +46,8 @@ typedef struct g2chip_config {
         void); /**< Function pointer to get a random byte */
 
     void (*debug_log)(const char* message);
+
+    g2chip_quirks_t quirks; /**< Behaviour differences between interpreters */
 } g2chip_config_t;
 /*--------------------------------------------------------------------------------------------------------------------*/
 g2chip_t* g2chip_create(const g2chip_config_t* config);
@@ -41,5 +55,8 @@ void g2chip_destroy(g2chip_t* chip);
 int g2chip_load_rom(g2chip_t* chip, const uint8_t* rom_data, size_t size);
 void g2chip_reset(g2chip_t* chip);
 void g2chip_step(g2chip_t* chip);
+/** Bit K set = key K pressed; used without key callbacks. FX0A waits for a key that goes from released to pressed */
+void g2chip_set_keypad(g2chip_t* chip, uint16_t keypad);
+const uint8_t* g2chip_get_display(const g2chip_t* chip); /**< WIDTH * HEIGHT pixels, one byte (0 or 1) each */
 /*--------------------------------------------------------------------------------------------------------------------*/
 #endif  // G2CHIP_H
\ No newline at end of file
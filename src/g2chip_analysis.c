@@ -0,0 +1,438 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include "g2chip_analysis.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define ANALYSIS_I_UNVISITED 0
+#define ANALYSIS_I_KNOWN 1
+#define ANALYSIS_I_UNKNOWN 2
+/* Every address changes its I state at most twice (unvisited -> known -> unknown), bounding the worklist */
+#define ANALYSIS_WORKLIST_SIZE (2 * G2CHIP_MEMORY_SIZE)
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef enum analysis_flow {
+    ANALYSIS_FLOW_NEXT,
+    ANALYSIS_FLOW_JUMP,
+    ANALYSIS_FLOW_CALL,
+    ANALYSIS_FLOW_SKIP,
+    ANALYSIS_FLOW_RETURN,
+    ANALYSIS_FLOW_INDIRECT,
+    ANALYSIS_FLOW_INVALID,
+} analysis_flow_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct analysis_context {
+    uint8_t memory[G2CHIP_MEMORY_SIZE];
+    uint8_t i_state[G2CHIP_MEMORY_SIZE]; /**< Abstract value of I on entry to each instruction */
+    uint16_t i_value[G2CHIP_MEMORY_SIZE];
+    uint16_t worklist[ANALYSIS_WORKLIST_SIZE];
+    size_t worklist_size;
+} analysis_context_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint16_t fetch_raw(const analysis_context_t* context, uint16_t address) {
+    return (uint16_t)((context->memory[address & G2CHIP_ADDRESS_MASK] << 8) |
+                      context->memory[(address + 1) & G2CHIP_ADDRESS_MASK]);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static analysis_flow_t decode_flow(uint16_t raw) {
+    uint8_t nn = raw & 0x00FF;
+    switch ((raw & 0xF000) >> 12) {
+        case 0x0:
+            if (raw == 0x00E0) {
+                return ANALYSIS_FLOW_NEXT;
+            }
+            return (raw == 0x00EE) ? ANALYSIS_FLOW_RETURN : ANALYSIS_FLOW_INVALID;
+        case 0x1:
+            return ANALYSIS_FLOW_JUMP;
+        case 0x2:
+            return ANALYSIS_FLOW_CALL;
+        case 0x3:
+        case 0x4:
+        case 0x5:
+        case 0x9:
+            return ANALYSIS_FLOW_SKIP;
+        case 0x8:
+            return ((raw & 0x000F) <= 0x7 || (raw & 0x000F) == 0xE) ? ANALYSIS_FLOW_NEXT : ANALYSIS_FLOW_INVALID;
+        case 0xB:
+            return ANALYSIS_FLOW_INDIRECT;
+        case 0xE:
+            return (nn == 0x9E || nn == 0xA1) ? ANALYSIS_FLOW_SKIP : ANALYSIS_FLOW_INVALID;
+        case 0xF:
+            switch (nn) {
+                case 0x07:
+                case 0x0A:
+                case 0x15:
+                case 0x18:
+                case 0x1E:
+                case 0x29:
+                case 0x33:
+                case 0x55:
+                case 0x65:
+                    return ANALYSIS_FLOW_NEXT;
+                default:
+                    return ANALYSIS_FLOW_INVALID;
+            }
+        default:
+            return ANALYSIS_FLOW_NEXT;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t flow_successors(uint16_t address, uint16_t raw, analysis_flow_t flow, uint16_t successors[2]) {
+    switch (flow) {
+        case ANALYSIS_FLOW_NEXT:
+        case ANALYSIS_FLOW_INVALID:  // The core logs and steps over opcodes it does not implement
+            successors[0] = (address + 2) & G2CHIP_ADDRESS_MASK;
+            return 1;
+        case ANALYSIS_FLOW_JUMP:
+            successors[0] = raw & 0x0FFF;
+            return 1;
+        case ANALYSIS_FLOW_CALL:
+            successors[0] = raw & 0x0FFF;
+            successors[1] = (address + 2) & G2CHIP_ADDRESS_MASK;
+            return 2;
+        case ANALYSIS_FLOW_SKIP:
+            successors[0] = (address + 2) & G2CHIP_ADDRESS_MASK;
+            successors[1] = (address + 4) & G2CHIP_ADDRESS_MASK;
+            return 2;
+        case ANALYSIS_FLOW_RETURN:
+            // The core steps over a RET on an empty stack, and the analysis does not track stack depth
+            successors[0] = (address + 2) & G2CHIP_ADDRESS_MASK;
+            return 1;
+        default:
+            return 0;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void propagate(analysis_context_t* context, uint16_t address, uint8_t state, uint16_t value) {
+    address &= G2CHIP_ADDRESS_MASK;
+    uint8_t current = context->i_state[address];
+    if (current == ANALYSIS_I_UNKNOWN) {
+        return;
+    }
+    if (current == ANALYSIS_I_KNOWN) {
+        if (state == ANALYSIS_I_KNOWN && context->i_value[address] == value) {
+            return;
+        }
+        state = ANALYSIS_I_UNKNOWN;
+    }
+    context->i_state[address] = state;
+    context->i_value[address] = value;
+    context->worklist[context->worklist_size++] = address;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void follow_control_flow(analysis_context_t* context) {
+    propagate(context, G2CHIP_PROGRAM_START_ADDRESS, ANALYSIS_I_KNOWN, 0);
+
+    while (context->worklist_size > 0) {
+        uint16_t address = context->worklist[--context->worklist_size];
+        uint16_t raw = fetch_raw(context, address);
+        uint8_t state = context->i_state[address];
+        uint16_t value = context->i_value[address];
+
+        if ((raw & 0xF000) == 0xA000) {
+            state = ANALYSIS_I_KNOWN;
+            value = raw & 0x0FFF;
+        } else if ((raw & 0xF0FF) == 0xF01E || (raw & 0xF0FF) == 0xF029) {
+            state = ANALYSIS_I_UNKNOWN;
+        }
+
+        analysis_flow_t flow = decode_flow(raw);
+        uint16_t successors[2];
+        uint8_t successor_count = flow_successors(address, raw, flow, successors);
+        for (uint8_t i = 0; i < successor_count; i++) {
+            // A subroutine may change I before returning, so nothing is known at the return site or past a RET
+            uint8_t successor_state =
+                ((flow == ANALYSIS_FLOW_CALL && i == 1) || flow == ANALYSIS_FLOW_RETURN) ? ANALYSIS_I_UNKNOWN : state;
+            propagate(context, successors[i], successor_state, value);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void mark_written(g2chip_analysis_t* analysis, uint16_t address) {
+    address &= G2CHIP_ADDRESS_MASK;
+    size_t page = address / G2CHIP_ANALYSIS_PAGE_SIZE;
+    analysis->map[address] |= G2CHIP_ANALYSIS_WRITTEN;
+    analysis->written_pages[page / 32] |= 1UL << (page % 32);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void record_writes(g2chip_analysis_t* analysis, const analysis_context_t* context, uint16_t address,
+                          uint16_t raw) {
+    size_t write_count;
+    if ((raw & 0xF0FF) == 0xF033) {
+        write_count = 3;
+    } else if ((raw & 0xF0FF) == 0xF055) {
+        write_count = ((raw & 0x0F00) >> 8) + 1;
+    } else {
+        return;
+    }
+
+    if (context->i_state[address] != ANALYSIS_I_KNOWN) {
+        analysis->unresolved_write_count++;
+        return;
+    }
+    for (size_t i = 0; i < write_count; i++) {
+        mark_written(analysis, (uint16_t)(context->i_value[address] + i));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void collect_instructions(g2chip_analysis_t* analysis, const analysis_context_t* context) {
+    analysis->map[G2CHIP_PROGRAM_START_ADDRESS] |= G2CHIP_ANALYSIS_BLOCK_START;
+
+    for (size_t address = 0; address < G2CHIP_MEMORY_SIZE; address++) {
+        if (context->i_state[address] == ANALYSIS_I_UNVISITED) {
+            continue;
+        }
+        uint16_t raw = fetch_raw(context, (uint16_t)address);
+        analysis_flow_t flow = decode_flow(raw);
+        uint16_t successors[2];
+        uint8_t successor_count = flow_successors((uint16_t)address, raw, flow, successors);
+
+        analysis->instruction_count++;
+        analysis->map[address] |= G2CHIP_ANALYSIS_CODE | G2CHIP_ANALYSIS_INSTRUCTION;
+        analysis->map[(address + 1) & G2CHIP_ADDRESS_MASK] |= G2CHIP_ANALYSIS_CODE;
+
+        switch (flow) {
+            case ANALYSIS_FLOW_JUMP:
+                analysis->jump_count++;
+                analysis->map[successors[0]] |= G2CHIP_ANALYSIS_JUMP_TARGET | G2CHIP_ANALYSIS_BLOCK_START;
+                break;
+            case ANALYSIS_FLOW_CALL:
+                analysis->call_count++;
+                analysis->map[successors[0]] |= G2CHIP_ANALYSIS_CALL_TARGET | G2CHIP_ANALYSIS_BLOCK_START;
+                analysis->map[successors[1]] |= G2CHIP_ANALYSIS_BLOCK_START;
+                break;
+            case ANALYSIS_FLOW_RETURN:
+                analysis->map[successors[0]] |= G2CHIP_ANALYSIS_BLOCK_START;
+                break;
+            case ANALYSIS_FLOW_SKIP:
+                analysis->skip_count++;
+                for (uint8_t i = 0; i < successor_count; i++) {
+                    analysis->map[successors[i]] |= G2CHIP_ANALYSIS_BLOCK_START;
+                }
+                break;
+            case ANALYSIS_FLOW_INDIRECT:
+                analysis->indirect_jump_count++;
+                break;
+            case ANALYSIS_FLOW_INVALID:
+                analysis->invalid_count++;
+                analysis->map[address] |= G2CHIP_ANALYSIS_INVALID;
+                break;
+            default:
+                break;
+        }
+
+        record_writes(analysis, context, (uint16_t)address, raw);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int build_blocks(g2chip_analysis_t* analysis, const analysis_context_t* context) {
+    analysis->blocks = (g2chip_analysis_block_t*)calloc(analysis->instruction_count + 1, sizeof(*analysis->blocks));
+    if (analysis->blocks == NULL) {
+        return -1;
+    }
+
+    for (size_t address = 0; address < G2CHIP_MEMORY_SIZE; address++) {
+        if ((analysis->map[address] & G2CHIP_ANALYSIS_BLOCK_START) == 0 ||
+            (analysis->map[address] & G2CHIP_ANALYSIS_INSTRUCTION) == 0) {
+            continue;
+        }
+
+        g2chip_analysis_block_t* block = &analysis->blocks[analysis->block_count++];
+        uint16_t current = (uint16_t)address;
+        for (;;) {
+            uint16_t raw = fetch_raw(context, current);
+            analysis_flow_t flow = decode_flow(raw);
+            block->successor_count = flow_successors(current, raw, flow, block->successors);
+            if ((flow != ANALYSIS_FLOW_NEXT && flow != ANALYSIS_FLOW_INVALID) ||
+                (analysis->map[block->successors[0]] & G2CHIP_ANALYSIS_BLOCK_START)) {
+                break;
+            }
+            current = block->successors[0];
+        }
+        block->start = (uint16_t)address;
+        block->last = current;
+    }
+
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void summarize_writes(g2chip_analysis_t* analysis) {
+    for (size_t address = 0; address < G2CHIP_MEMORY_SIZE; address++) {
+        if (analysis->map[address] & G2CHIP_ANALYSIS_CODE) {
+            // Execution can run on past the image through zeroed memory; only ROM bytes split into code and data
+            if (address >= G2CHIP_PROGRAM_START_ADDRESS &&
+                address - G2CHIP_PROGRAM_START_ADDRESS < analysis->rom_size) {
+                analysis->code_size++;
+            }
+            if (analysis->map[address] & G2CHIP_ANALYSIS_WRITTEN) {
+                analysis->self_modifying_count++;
+            }
+        }
+    }
+
+    // Code behind a BNNN was never visited, rewritten code runs bytes the analysis never saw, and a ROM reaching
+    // unimplemented opcodes targets another interpreter, so their writes are unknown like an FX33/FX55 with unknown I
+    if (analysis->unresolved_write_count > 0 || analysis->indirect_jump_count > 0 || analysis->invalid_count > 0 ||
+        analysis->self_modifying_count > 0) {
+        for (size_t page = 0; page < G2CHIP_ANALYSIS_PAGE_COUNT; page++) {
+            analysis->written_pages[page / 32] |= 1UL << (page % 32);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_analysis_t* g2chip_analysis_create(const uint8_t* rom_data, size_t size) {
+    if (rom_data == NULL || size == 0 || size > G2CHIP_MAX_ROM_SIZE) {
+        return NULL;
+    }
+
+    g2chip_analysis_t* analysis = (g2chip_analysis_t*)calloc(1, sizeof(g2chip_analysis_t));
+    analysis_context_t* context = (analysis_context_t*)calloc(1, sizeof(analysis_context_t));
+    if (analysis == NULL || context == NULL) {
+        free(context);
+        free(analysis);
+        return NULL;
+    }
+
+    analysis->rom_size = size;
+    memcpy(&context->memory[G2CHIP_PROGRAM_START_ADDRESS], rom_data, size);
+
+    follow_control_flow(context);
+    collect_instructions(analysis, context);
+    if (build_blocks(analysis, context) != 0) {
+        free(context);
+        g2chip_analysis_destroy(analysis);
+        return NULL;
+    }
+    summarize_writes(analysis);
+
+    free(context);
+    return analysis;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_analysis_destroy(g2chip_analysis_t* analysis) {
+    if (analysis != NULL) {
+        free(analysis->blocks);
+        free(analysis);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_analysis_page_is_written(const g2chip_analysis_t* analysis, uint16_t address) {
+    if (analysis == NULL) {
+        return 1;
+    }
+    size_t page = (address & G2CHIP_ADDRESS_MASK) / G2CHIP_ANALYSIS_PAGE_SIZE;
+    return (analysis->written_pages[page / 32] >> (page % 32)) & 1;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+const char* g2chip_analysis_classify(const g2chip_analysis_t* analysis) {
+    if (analysis->self_modifying_count > 0) {
+        return "self-modifying";
+    }
+    if (analysis->unresolved_write_count > 0) {
+        return "unresolved-writes";
+    }
+    if (analysis->indirect_jump_count > 0) {
+        return "indirect-jumps";
+    }
+    if (analysis->invalid_count > 0) {
+        return "invalid-opcodes";
+    }
+    return "static";
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_analysis_disassemble(uint16_t raw, char* buffer, size_t size) {
+    static const char* const alu_mnemonics[16] = {
+        "LD", "OR", "AND", "XOR", "ADD", "SUB", "SHR", "SUBN", NULL, NULL, NULL, NULL, NULL, NULL, "SHL", NULL,
+    };
+    uint8_t x = (raw & 0x0F00) >> 8;
+    uint8_t y = (raw & 0x00F0) >> 4;
+    uint8_t n = raw & 0x000F;
+    uint8_t nn = raw & 0x00FF;
+    uint16_t nnn = raw & 0x0FFF;
+
+    if (decode_flow(raw) == ANALYSIS_FLOW_INVALID) {
+        snprintf(buffer, size, "DW 0x%04X", raw);
+        return;
+    }
+
+    switch ((raw & 0xF000) >> 12) {
+        case 0x0:
+            snprintf(buffer, size, "%s", (raw == 0x00E0) ? "CLS" : "RET");
+            break;
+        case 0x1:
+            snprintf(buffer, size, "JP 0x%03X", nnn);
+            break;
+        case 0x2:
+            snprintf(buffer, size, "CALL 0x%03X", nnn);
+            break;
+        case 0x3:
+            snprintf(buffer, size, "SE V%X, 0x%02X", x, nn);
+            break;
+        case 0x4:
+            snprintf(buffer, size, "SNE V%X, 0x%02X", x, nn);
+            break;
+        case 0x5:
+            snprintf(buffer, size, "SE V%X, V%X", x, y);
+            break;
+        case 0x6:
+            snprintf(buffer, size, "LD V%X, 0x%02X", x, nn);
+            break;
+        case 0x7:
+            snprintf(buffer, size, "ADD V%X, 0x%02X", x, nn);
+            break;
+        case 0x8:
+            snprintf(buffer, size, "%s V%X, V%X", alu_mnemonics[n], x, y);
+            break;
+        case 0x9:
+            snprintf(buffer, size, "SNE V%X, V%X", x, y);
+            break;
+        case 0xA:
+            snprintf(buffer, size, "LD I, 0x%03X", nnn);
+            break;
+        case 0xB:
+            snprintf(buffer, size, "JP V0, 0x%03X", nnn);
+            break;
+        case 0xC:
+            snprintf(buffer, size, "RND V%X, 0x%02X", x, nn);
+            break;
+        case 0xD:
+            snprintf(buffer, size, "DRW V%X, V%X, %u", x, y, n);
+            break;
+        case 0xE:
+            snprintf(buffer, size, "%s V%X", (nn == 0x9E) ? "SKP" : "SKNP", x);
+            break;
+        default:
+            switch (nn) {
+                case 0x07:
+                    snprintf(buffer, size, "LD V%X, DT", x);
+                    break;
+                case 0x0A:
+                    snprintf(buffer, size, "LD V%X, K", x);
+                    break;
+                case 0x15:
+                    snprintf(buffer, size, "LD DT, V%X", x);
+                    break;
+                case 0x18:
+                    snprintf(buffer, size, "LD ST, V%X", x);
+                    break;
+                case 0x1E:
+                    snprintf(buffer, size, "ADD I, V%X", x);
+                    break;
+                case 0x29:
+                    snprintf(buffer, size, "LD F, V%X", x);
+                    break;
+                case 0x33:
+                    snprintf(buffer, size, "LD B, V%X", x);
+                    break;
+                case 0x55:
+                    snprintf(buffer, size, "LD [I], V%X", x);
+                    break;
+                default:
+                    snprintf(buffer, size, "LD V%X, [I]", x);
+                    break;
+            }
+            break;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
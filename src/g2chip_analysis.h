@@ -0,0 +1,58 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#ifndef G2CHIP_ANALYSIS_H
+#define G2CHIP_ANALYSIS_H
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "g2chip.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define G2CHIP_ANALYSIS_VERSION 4 /**< Bump whenever the results for a given ROM change, invalidating cached analyses */
+#define G2CHIP_ANALYSIS_PAGE_SIZE 256
+#define G2CHIP_ANALYSIS_PAGE_COUNT (G2CHIP_MEMORY_SIZE / G2CHIP_ANALYSIS_PAGE_SIZE)
+#define G2CHIP_ANALYSIS_PAGE_WORD_COUNT ((G2CHIP_ANALYSIS_PAGE_COUNT + 31) / 32)
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* Flags stored per address in g2chip_analysis_t::map */
+#define G2CHIP_ANALYSIS_CODE 0x01        /**< Byte belongs to a reachable instruction */
+#define G2CHIP_ANALYSIS_INSTRUCTION 0x02 /**< First byte of a reachable instruction */
+#define G2CHIP_ANALYSIS_BLOCK_START 0x04 /**< First instruction of a basic block */
+#define G2CHIP_ANALYSIS_JUMP_TARGET 0x08 /**< Target of a 1NNN jump */
+#define G2CHIP_ANALYSIS_CALL_TARGET 0x10 /**< Target of a 2NNN call */
+#define G2CHIP_ANALYSIS_WRITTEN 0x20     /**< Byte can be written by FX33/FX55 */
+#define G2CHIP_ANALYSIS_INVALID 0x40     /**< Reachable instruction the core does not implement */
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_analysis_block {
+    uint16_t start;           /**< Address of the first instruction */
+    uint16_t last;            /**< Address of the last instruction */
+    uint16_t successors[2];   /**< Jump/call/skip targets and fall-through address */
+    uint8_t successor_count;  /**< 0 for BNNN, RET and invalid opcodes fall through */
+} g2chip_analysis_block_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_analysis {
+    size_t rom_size;
+    uint8_t map[G2CHIP_MEMORY_SIZE];
+    uint32_t written_pages[G2CHIP_ANALYSIS_PAGE_WORD_COUNT]; /**< Pages FX33/FX55 can write at runtime */
+    g2chip_analysis_block_t* blocks;                         /**< Control-flow graph, sorted by start address */
+    size_t block_count;
+
+    size_t code_size; /**< ROM bytes that belong to reachable instructions */
+    size_t instruction_count;
+    size_t jump_count;
+    size_t call_count;
+    size_t skip_count;
+    size_t indirect_jump_count;   /**< BNNN jumps whose targets cannot be followed; every page is then written */
+    size_t invalid_count;         /**< Reachable opcodes the core skips over; every page is then written */
+    size_t unresolved_write_count; /**< FX33/FX55 with an unknown I; every page is then considered written */
+    size_t self_modifying_count;  /**< Code bytes that FX33/FX55 can overwrite; every page is then written */
+} g2chip_analysis_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_analysis_t* g2chip_analysis_create(const uint8_t* rom_data, size_t size);
+void g2chip_analysis_destroy(g2chip_analysis_t* analysis);
+int g2chip_analysis_page_is_written(const g2chip_analysis_t* analysis, uint16_t address);
+/** "static" when every write was resolved, otherwise the reason every page counts as written */
+const char* g2chip_analysis_classify(const g2chip_analysis_t* analysis);
+void g2chip_analysis_disassemble(uint16_t raw, char* buffer, size_t size);
+/*--------------------------------------------------------------------------------------------------------------------*/
+#endif  // G2CHIP_ANALYSIS_H
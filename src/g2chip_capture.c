@@ -0,0 +1,526 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include "g2chip_capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define CAPTURE_INITIAL_CAPACITY 4096
+#define CAPTURE_FLUSH_SIZE 65536 /**< File-backed captures write out their buffer once it holds this much */
+#define CAPTURE_MAX_FRAME_SIZE (G2CHIP_DISPLAY_HEIGHT * (2 + G2CHIP_CAPTURE_ROW_SIZE))
+#define CAPTURE_PATH_SIZE 512
+#define PNG_STORED_BLOCK_SIZE 65535
+#define GIF_MIN_CODE_SIZE 2
+#define GIF_MAX_CODE_COUNT 4096
+#define GIF_HASH_SIZE 5003
+#define GIF_SUB_BLOCK_SIZE 255
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef uint8_t capture_rows_t[G2CHIP_DISPLAY_HEIGHT][G2CHIP_CAPTURE_ROW_SIZE];
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_capture {
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    size_t frame_count;
+    capture_rows_t previous;
+    FILE* file; /**< When set, data only holds the part of the stream not yet written to it */
+    int error;
+} g2chip_capture_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct gif_writer {
+    FILE* file;
+    uint8_t block[GIF_SUB_BLOCK_SIZE];
+    size_t block_size;
+    uint32_t bit_buffer;
+    uint8_t bit_count;
+    int32_t hash_keys[GIF_HASH_SIZE];
+    uint16_t hash_codes[GIF_HASH_SIZE];
+} gif_writer_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int reserve(g2chip_capture_t* capture, size_t extra) {
+    if (capture->size + extra <= capture->capacity) {
+        return 0;
+    }
+    size_t capacity = capture->capacity;
+    while (capture->size + extra > capacity) {
+        capacity *= 2;
+    }
+    uint8_t* data = (uint8_t*)realloc(capture->data, capacity);
+    if (data == NULL) {
+        return -1;
+    }
+    capture->data = data;
+    capture->capacity = capacity;
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void pack_rows(const uint8_t* display, capture_rows_t rows) {
+    for (size_t y = 0; y < G2CHIP_DISPLAY_HEIGHT; y++) {
+        const uint8_t* pixels = &display[y * G2CHIP_DISPLAY_WIDTH];
+        for (size_t byte = 0; byte < G2CHIP_CAPTURE_ROW_SIZE; byte++) {
+            uint8_t value = 0;
+            for (size_t bit = 0; bit < 8; bit++) {
+                value = (uint8_t)((value << 1) | (pixels[byte * 8 + bit] & 0x01));
+            }
+            rows[y][byte] = value;
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t row_pixel(capture_rows_t rows, size_t x, size_t y) {
+    return (rows[y][x / 8] >> (7 - (x % 8))) & 0x01;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_capture_t* g2chip_capture_create(void) {
+    g2chip_capture_t* capture = (g2chip_capture_t*)calloc(1, sizeof(g2chip_capture_t));
+    if (capture == NULL) {
+        return NULL;
+    }
+
+    capture->capacity = CAPTURE_INITIAL_CAPACITY;
+    capture->data = (uint8_t*)malloc(capture->capacity);
+    if (capture->data == NULL) {
+        free(capture);
+        return NULL;
+    }
+
+    memcpy(capture->data, G2CHIP_CAPTURE_MAGIC, 4);
+    capture->data[4] = G2CHIP_CAPTURE_VERSION;
+    capture->data[5] = G2CHIP_DISPLAY_WIDTH;
+    capture->data[6] = G2CHIP_DISPLAY_HEIGHT;
+    capture->data[7] = 0;
+    capture->size = G2CHIP_CAPTURE_HEADER_SIZE;
+
+    return capture;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_capture_t* g2chip_capture_create_file(FILE* file) {
+    if (file == NULL) {
+        return NULL;
+    }
+
+    g2chip_capture_t* capture = g2chip_capture_create();
+    if (capture != NULL) {
+        capture->file = file;
+    }
+    return capture;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_capture_destroy(g2chip_capture_t* capture) {
+    if (capture != NULL) {
+        g2chip_capture_flush(capture);
+        free(capture->data);
+        free(capture);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_frame(g2chip_capture_t* capture, const uint8_t* display) {
+    if (capture == NULL || display == NULL || reserve(capture, CAPTURE_MAX_FRAME_SIZE) != 0) {
+        return -1;
+    }
+
+    capture_rows_t current;
+    pack_rows(display, current);
+
+    uint8_t* out = &capture->data[capture->size];
+    size_t y = 0;
+    while (y < G2CHIP_DISPLAY_HEIGHT) {
+        uint8_t skip = 0;
+        while (y < G2CHIP_DISPLAY_HEIGHT && memcmp(current[y], capture->previous[y], G2CHIP_CAPTURE_ROW_SIZE) == 0) {
+            skip++;
+            y++;
+        }
+        size_t run_start = y;
+        while (y < G2CHIP_DISPLAY_HEIGHT && memcmp(current[y], capture->previous[y], G2CHIP_CAPTURE_ROW_SIZE) != 0) {
+            y++;
+        }
+        size_t run = y - run_start;
+
+        *out++ = skip;
+        *out++ = (uint8_t)run;
+        memcpy(out, current[run_start], run * G2CHIP_CAPTURE_ROW_SIZE);
+        out += run * G2CHIP_CAPTURE_ROW_SIZE;
+    }
+
+    capture->size = (size_t)(out - capture->data);
+    memcpy(capture->previous, current, sizeof(current));
+    capture->frame_count++;
+
+    if (capture->file != NULL && capture->size >= CAPTURE_FLUSH_SIZE) {
+        return g2chip_capture_flush(capture);
+    }
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_flush(g2chip_capture_t* capture) {
+    if (capture == NULL) {
+        return -1;
+    }
+    if (capture->file == NULL) {
+        return 0;  // In-memory captures keep the whole stream
+    }
+
+    if (capture->size > 0 && fwrite(capture->data, 1, capture->size, capture->file) != capture->size) {
+        capture->error = 1;
+    }
+    capture->size = 0;
+    if (fflush(capture->file) != 0) {
+        capture->error = 1;
+    }
+    return capture->error ? -1 : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+size_t g2chip_capture_frame_count(const g2chip_capture_t* capture) {
+    return (capture != NULL) ? capture->frame_count : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+const uint8_t* g2chip_capture_data(const g2chip_capture_t* capture, size_t* size) {
+    if (capture == NULL || size == NULL || capture->file != NULL) {
+        return NULL;
+    }
+    *size = capture->size;
+    return capture->data;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_write(const g2chip_capture_t* capture, const char* path) {
+    if (capture == NULL || path == NULL || capture->file != NULL) {
+        return -1;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+    size_t written = fwrite(capture->data, 1, capture->size, file);
+    fclose(file);
+    return (written == capture->size) ? 0 : -1;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_reader_open(g2chip_capture_reader_t* reader, const uint8_t* stream, size_t size) {
+    if (reader == NULL || stream == NULL || size < G2CHIP_CAPTURE_HEADER_SIZE ||
+        memcmp(stream, G2CHIP_CAPTURE_MAGIC, 4) != 0 || stream[4] != G2CHIP_CAPTURE_VERSION ||
+        stream[5] != G2CHIP_DISPLAY_WIDTH || stream[6] != G2CHIP_DISPLAY_HEIGHT) {
+        return -1;
+    }
+
+    memset(reader, 0, sizeof(*reader));
+    reader->stream = stream;
+    reader->size = size;
+    reader->offset = G2CHIP_CAPTURE_HEADER_SIZE;
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_reader_next(g2chip_capture_reader_t* reader, uint8_t* display) {
+    if (reader == NULL) {
+        return -1;
+    }
+    if (reader->offset == reader->size) {
+        return 0;
+    }
+
+    size_t y = 0;
+    while (y < G2CHIP_DISPLAY_HEIGHT) {
+        if (reader->size - reader->offset < 2) {
+            return -1;
+        }
+        size_t skip = reader->stream[reader->offset++];
+        size_t run = reader->stream[reader->offset++];
+        size_t run_size = run * G2CHIP_CAPTURE_ROW_SIZE;
+        if ((skip == 0 && run == 0) || y + skip + run > G2CHIP_DISPLAY_HEIGHT ||
+            reader->size - reader->offset < run_size) {
+            return -1;
+        }
+        y += skip;
+        memcpy(reader->rows[y], &reader->stream[reader->offset], run_size);
+        reader->offset += run_size;
+        y += run;
+    }
+
+    for (size_t pixel = 0; display != NULL && pixel < G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT; pixel++) {
+        display[pixel] = row_pixel(reader->rows, pixel % G2CHIP_DISPLAY_WIDTH, pixel / G2CHIP_DISPLAY_WIDTH);
+    }
+    return 1;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void crc32_init_table(uint32_t table[256]) {
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (0xEDB88320UL ^ (c >> 1)) : (c >> 1);
+        }
+        table[n] = c;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint32_t crc32_update(const uint32_t table[256], uint32_t crc, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void put_u32_be(uint8_t* out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void png_write_chunk(FILE* file, const uint32_t crc_table[256], const char* type, const uint8_t* data,
+                            size_t size) {
+    uint8_t header[8];
+    put_u32_be(header, (uint32_t)size);
+    memcpy(&header[4], type, 4);
+    uint32_t crc = crc32_update(crc_table, 0xFFFFFFFFUL, &header[4], 4);
+    crc = crc32_update(crc_table, crc, data, size) ^ 0xFFFFFFFFUL;
+    uint8_t trailer[4];
+    put_u32_be(trailer, crc);
+
+    fwrite(header, 1, sizeof(header), file);
+    if (size > 0) {
+        fwrite(data, 1, size, file);
+    }
+    fwrite(trailer, 1, sizeof(trailer), file);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* 1-bit grayscale PNG with stored (uncompressed) deflate blocks, so no zlib dependency is needed */
+static int png_write_frame(const char* path, const uint32_t crc_table[256], capture_rows_t rows, uint8_t scale) {
+    uint32_t width = G2CHIP_DISPLAY_WIDTH * scale;
+    uint32_t height = G2CHIP_DISPLAY_HEIGHT * scale;
+    size_t stride = 1 + (width + 7) / 8;
+    size_t raw_size = stride * height;
+    size_t block_count = (raw_size + PNG_STORED_BLOCK_SIZE - 1) / PNG_STORED_BLOCK_SIZE;
+    size_t idat_size = 2 + block_count * 5 + raw_size + 4;
+
+    uint8_t* idat = (uint8_t*)calloc(1, idat_size);
+    uint8_t* raw = (uint8_t*)calloc(1, raw_size);
+    if (idat == NULL || raw == NULL) {
+        free(raw);
+        free(idat);
+        return -1;
+    }
+
+    for (uint32_t y = 0; y < height; y++) {
+        uint8_t* line = &raw[y * stride + 1];  // Leading filter byte stays 0 (None)
+        for (uint32_t x = 0; x < width; x++) {
+            if (row_pixel(rows, x / scale, y / scale)) {
+                line[x / 8] |= (uint8_t)(0x80 >> (x % 8));
+            }
+        }
+    }
+
+    uint8_t* out = idat;
+    *out++ = 0x78;  // zlib header: deflate, 32 KB window, no preset dictionary
+    *out++ = 0x01;
+    uint32_t adler_a = 1;
+    uint32_t adler_b = 0;
+    for (size_t offset = 0; offset < raw_size; offset += PNG_STORED_BLOCK_SIZE) {
+        size_t length = raw_size - offset;
+        if (length > PNG_STORED_BLOCK_SIZE) {
+            length = PNG_STORED_BLOCK_SIZE;
+        }
+        *out++ = (offset + length == raw_size) ? 1 : 0;
+        *out++ = (uint8_t)length;
+        *out++ = (uint8_t)(length >> 8);
+        *out++ = (uint8_t)~length;
+        *out++ = (uint8_t)(~length >> 8);
+        memcpy(out, &raw[offset], length);
+        out += length;
+        for (size_t i = 0; i < length; i++) {
+            adler_a = (adler_a + raw[offset + i]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+    }
+    put_u32_be(out, (adler_b << 16) | adler_a);
+
+    uint8_t ihdr[13] = {0};
+    put_u32_be(&ihdr[0], width);
+    put_u32_be(&ihdr[4], height);
+    ihdr[8] = 1;  // Bit depth, color type 0 (grayscale)
+
+    int result = -1;
+    FILE* file = fopen(path, "wb");
+    if (file != NULL) {
+        static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        fwrite(signature, 1, sizeof(signature), file);
+        png_write_chunk(file, crc_table, "IHDR", ihdr, sizeof(ihdr));
+        png_write_chunk(file, crc_table, "IDAT", idat, idat_size);
+        png_write_chunk(file, crc_table, "IEND", NULL, 0);
+        result = ferror(file) ? -1 : 0;
+        fclose(file);
+    }
+
+    free(raw);
+    free(idat);
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_export_png(const uint8_t* stream, size_t size, const char* path_prefix, uint8_t scale) {
+    g2chip_capture_reader_t reader;
+    if (path_prefix == NULL || scale == 0 || g2chip_capture_reader_open(&reader, stream, size) != 0) {
+        return -1;
+    }
+
+    uint32_t crc_table[256];
+    crc32_init_table(crc_table);
+
+    int status;
+    size_t index = 0;
+    while ((status = g2chip_capture_reader_next(&reader, NULL)) == 1) {
+        char path[CAPTURE_PATH_SIZE];
+        snprintf(path, sizeof(path), "%s%05zu.png", path_prefix, index++);
+        if (png_write_frame(path, crc_table, reader.rows, scale) != 0) {
+            return -1;
+        }
+    }
+
+    return status;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void gif_flush_block(gif_writer_t* writer) {
+    if (writer->block_size > 0) {
+        fputc((int)writer->block_size, writer->file);
+        fwrite(writer->block, 1, writer->block_size, writer->file);
+        writer->block_size = 0;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void gif_put_code(gif_writer_t* writer, uint16_t code, uint8_t code_size) {
+    writer->bit_buffer |= (uint32_t)code << writer->bit_count;
+    writer->bit_count += code_size;
+    while (writer->bit_count >= 8) {
+        writer->block[writer->block_size++] = (uint8_t)writer->bit_buffer;
+        writer->bit_buffer >>= 8;
+        writer->bit_count -= 8;
+        if (writer->block_size == GIF_SUB_BLOCK_SIZE) {
+            gif_flush_block(writer);
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void gif_reset_dictionary(gif_writer_t* writer) {
+    for (size_t i = 0; i < GIF_HASH_SIZE; i++) {
+        writer->hash_keys[i] = -1;
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void gif_write_image_data(gif_writer_t* writer, const uint8_t* pixels, size_t count) {
+    const uint16_t clear_code = 1 << GIF_MIN_CODE_SIZE;
+    const uint16_t end_code = clear_code + 1;
+    uint16_t next_code = end_code + 1;
+    uint8_t code_size = GIF_MIN_CODE_SIZE + 1;
+
+    fputc(GIF_MIN_CODE_SIZE, writer->file);
+    writer->bit_buffer = 0;
+    writer->bit_count = 0;
+    writer->block_size = 0;
+    gif_reset_dictionary(writer);
+    gif_put_code(writer, clear_code, code_size);
+
+    uint16_t prefix = pixels[0];
+    for (size_t i = 1; i < count; i++) {
+        int32_t key = ((int32_t)prefix << 8) | pixels[i];
+        size_t slot = (size_t)(((uint32_t)pixels[i] << 12) ^ prefix) % GIF_HASH_SIZE;
+        while (writer->hash_keys[slot] != -1 && writer->hash_keys[slot] != key) {
+            slot = (slot + 1) % GIF_HASH_SIZE;
+        }
+        if (writer->hash_keys[slot] == key) {
+            prefix = writer->hash_codes[slot];
+            continue;
+        }
+
+        gif_put_code(writer, prefix, code_size);
+        if (next_code < GIF_MAX_CODE_COUNT) {
+            writer->hash_keys[slot] = key;
+            writer->hash_codes[slot] = next_code++;
+            if (next_code > (1 << code_size) && code_size < 12) {
+                code_size++;
+            }
+        } else {
+            gif_put_code(writer, clear_code, code_size);
+            gif_reset_dictionary(writer);
+            next_code = end_code + 1;
+            code_size = GIF_MIN_CODE_SIZE + 1;
+        }
+        prefix = pixels[i];
+    }
+
+    gif_put_code(writer, prefix, code_size);
+    gif_put_code(writer, end_code, code_size);
+    if (writer->bit_count > 0) {
+        gif_put_code(writer, 0, (uint8_t)(8 - writer->bit_count));
+    }
+    gif_flush_block(writer);
+    fputc(0, writer->file);  // Block terminator
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void put_u16_le(uint8_t* out, uint16_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_export_gif(const uint8_t* stream, size_t size, const char* path, uint8_t scale,
+                              uint16_t frame_delay_cs) {
+    g2chip_capture_reader_t reader;
+    if (path == NULL || scale == 0 || g2chip_capture_reader_open(&reader, stream, size) != 0) {
+        return -1;
+    }
+
+    uint16_t width = (uint16_t)(G2CHIP_DISPLAY_WIDTH * scale);
+    uint16_t height = (uint16_t)(G2CHIP_DISPLAY_HEIGHT * scale);
+    size_t pixel_count = (size_t)width * height;
+    uint8_t* pixels = (uint8_t*)malloc(pixel_count);
+    gif_writer_t* writer = (gif_writer_t*)calloc(1, sizeof(gif_writer_t));
+    if (pixels == NULL || writer == NULL) {
+        free(writer);
+        free(pixels);
+        return -1;
+    }
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        free(writer);
+        free(pixels);
+        return -1;
+    }
+
+    // Header, logical screen with a two-entry global color table (black, white) and an infinite loop extension
+    uint8_t screen[13] = {'G', 'I', 'F', '8', '9', 'a'};
+    put_u16_le(&screen[6], width);
+    put_u16_le(&screen[8], height);
+    screen[10] = 0x80;
+    fwrite(screen, 1, sizeof(screen), writer->file);
+    static const uint8_t palette[6] = {0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF};
+    fwrite(palette, 1, sizeof(palette), writer->file);
+    static const uint8_t loop[19] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P',
+                                     'E',  '2',  '.',  '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+    fwrite(loop, 1, sizeof(loop), writer->file);
+
+    int status;
+    while ((status = g2chip_capture_reader_next(&reader, NULL)) == 1) {
+        for (uint16_t y = 0; y < height; y++) {
+            for (uint16_t x = 0; x < width; x++) {
+                pixels[(size_t)y * width + x] = row_pixel(reader.rows, x / scale, y / scale);
+            }
+        }
+
+        uint8_t control[8] = {0x21, 0xF9, 0x04, 0x00};
+        put_u16_le(&control[4], frame_delay_cs);
+        fwrite(control, 1, sizeof(control), writer->file);
+        uint8_t descriptor[10] = {0x2C};
+        put_u16_le(&descriptor[5], width);
+        put_u16_le(&descriptor[7], height);
+        fwrite(descriptor, 1, sizeof(descriptor), writer->file);
+        gif_write_image_data(writer, pixels, pixel_count);
+    }
+
+    fputc(0x3B, writer->file);  // Trailer
+    if (ferror(writer->file)) {
+        status = -1;
+    }
+    fclose(writer->file);
+    free(writer);
+    free(pixels);
+    return status;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
@@ -0,0 +1,63 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#ifndef G2CHIP_CAPTURE_H
+#define G2CHIP_CAPTURE_H
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "g2chip.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*
+ * Capture stream layout:
+ *   header  "G2CV", version, width, height, 0
+ *   frame   (skip, run, run * row) pairs until skip + run covers every row of the display
+ *
+ * skip counts rows unchanged since the previous frame, run counts the changed rows that follow. Each row is stored as
+ * WIDTH / 8 bytes, most significant bit first. An unchanged frame costs two bytes.
+ */
+#define G2CHIP_CAPTURE_MAGIC "G2CV"
+#define G2CHIP_CAPTURE_VERSION 1
+#define G2CHIP_CAPTURE_HEADER_SIZE 8
+#define G2CHIP_CAPTURE_ROW_SIZE (G2CHIP_DISPLAY_WIDTH / 8)
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_capture g2chip_capture_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_capture_reader {
+    const uint8_t* stream;
+    size_t size;
+    size_t offset;
+    uint8_t rows[G2CHIP_DISPLAY_HEIGHT][G2CHIP_CAPTURE_ROW_SIZE]; /**< Last decoded frame, packed as in the stream */
+} g2chip_capture_reader_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+/** Keep the whole stream in memory, for g2chip_capture_data() and g2chip_capture_write() */
+g2chip_capture_t* g2chip_capture_create(void);
+/** Stream into file, holding at most a small buffer in memory; the caller closes file after destroying the capture */
+g2chip_capture_t* g2chip_capture_create_file(FILE* file);
+/** Flushes a file-backed capture, call g2chip_capture_flush() first to see write errors */
+void g2chip_capture_destroy(g2chip_capture_t* capture);
+/** Append a frame taken from g2chip_get_display() */
+int g2chip_capture_frame(g2chip_capture_t* capture, const uint8_t* display);
+/** Write out the buffered part of a file-backed capture, returns -1 if any write to the file failed */
+int g2chip_capture_flush(g2chip_capture_t* capture);
+size_t g2chip_capture_frame_count(const g2chip_capture_t* capture);
+/** NULL for file-backed captures */
+const uint8_t* g2chip_capture_data(const g2chip_capture_t* capture, size_t* size);
+int g2chip_capture_write(const g2chip_capture_t* capture, const char* path);
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_capture_reader_open(g2chip_capture_reader_t* reader, const uint8_t* stream, size_t size);
+/**
+ * Decode the next frame of the stream, unpacked into display (WIDTH * HEIGHT bytes, 0 or 1) unless it is NULL.
+ * Returns 1 for a frame, 0 at the end of the stream and -1 if the stream is corrupt.
+ */
+int g2chip_capture_reader_next(g2chip_capture_reader_t* reader, uint8_t* display);
+/*--------------------------------------------------------------------------------------------------------------------*/
+/** Write one <path_prefix>NNNNN.png per frame of a capture stream, each pixel scaled to scale x scale */
+int g2chip_capture_export_png(const uint8_t* stream, size_t size, const char* path_prefix, uint8_t scale);
+/** Write a capture stream as a looping animated GIF, frame_delay_cs in hundredths of a second */
+int g2chip_capture_export_gif(const uint8_t* stream, size_t size, const char* path, uint8_t scale,
+                              uint16_t frame_delay_cs);
+/*--------------------------------------------------------------------------------------------------------------------*/
+#endif  // G2CHIP_CAPTURE_H
@@ -0,0 +1,615 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
+#include "g2chip_corpus.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define CORPUS_PATH_SIZE 1024
+#define CORPUS_INITIAL_CAPACITY 64
+#define CORPUS_FNV_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define CORPUS_FNV_PRIME 0x100000001B3ULL
+#define CORPUS_PACK_HEADER_SIZE 8
+#define CACHE_BLOCK_SIZE 9
+#define CACHE_INSTRUCTION_SIZE 4
+#define CACHE_FIXED_SIZE (32 + 9 * 4 + 2 * 4 + G2CHIP_MEMORY_SIZE + G2CHIP_ANALYSIS_PAGE_WORD_COUNT * 4)
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct corpus_mapping {
+    void* address;
+    size_t size;
+} corpus_mapping_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_corpus {
+    g2chip_corpus_rom_t* roms;
+    size_t rom_count;
+    size_t rom_capacity;
+    corpus_mapping_t* mappings;
+    size_t mapping_count;
+    size_t mapping_capacity;
+    size_t duplicate_count;
+} g2chip_corpus_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* Bounds-checked little-endian reader/writer for cache records; any overrun sets error and stops further access */
+typedef struct cache_cursor {
+    uint8_t* data;
+    size_t size;
+    size_t offset;
+    int error;
+} cache_cursor_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int grow(void** array, size_t* capacity, size_t count, size_t element_size) {
+    if (count < *capacity) {
+        return 0;
+    }
+    size_t new_capacity = (*capacity == 0) ? CORPUS_INITIAL_CAPACITY : *capacity * 2;
+    void* new_array = realloc(*array, new_capacity * element_size);
+    if (new_array == NULL) {
+        return -1;
+    }
+    *array = new_array;
+    *capacity = new_capacity;
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static char* copy_name(const char* name, size_t length) {
+    char* copy = (char*)malloc(length + 1);
+    if (copy != NULL) {
+        memcpy(copy, name, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static const uint8_t* map_file(g2chip_corpus_t* corpus, const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+        grow((void**)&corpus->mappings, &corpus->mapping_capacity, corpus->mapping_count, sizeof(corpus_mapping_t))) {
+        close(fd);
+        return NULL;
+    }
+    void* address = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return NULL;
+    }
+
+    corpus->mappings[corpus->mapping_count].address = address;
+    corpus->mappings[corpus->mapping_count].size = (size_t)st.st_size;
+    corpus->mapping_count++;
+    *size = (size_t)st.st_size;
+    return (const uint8_t*)address;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int add_rom(g2chip_corpus_t* corpus, const char* name, size_t name_length, const uint8_t* data, size_t size) {
+    if (size == 0 || size > G2CHIP_MAX_ROM_SIZE) {
+        return 0;  // Not loadable, leave it out of the corpus
+    }
+    if (grow((void**)&corpus->roms, &corpus->rom_capacity, corpus->rom_count, sizeof(g2chip_corpus_rom_t)) != 0) {
+        return -1;
+    }
+    char* name_copy = copy_name(name, name_length);
+    if (name_copy == NULL) {
+        return -1;
+    }
+
+    g2chip_corpus_rom_t* rom = &corpus->roms[corpus->rom_count++];
+    rom->name = name_copy;
+    rom->data = data;
+    rom->size = size;
+    rom->hash = g2chip_corpus_hash(data, size);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int open_directory(g2chip_corpus_t* corpus, const char* path) {
+    DIR* directory = opendir(path);
+    if (directory == NULL) {
+        return -1;
+    }
+
+    char** names = NULL;
+    size_t name_count = 0;
+    size_t name_capacity = 0;
+    int result = 0;
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        char* name = copy_name(entry->d_name, strlen(entry->d_name));
+        if (name == NULL || grow((void**)&names, &name_capacity, name_count, sizeof(char*)) != 0) {
+            free(name);
+            result = -1;
+            break;
+        }
+        names[name_count++] = name;
+    }
+    closedir(directory);
+
+    // Sorted so ROM indices are stable across runs and file systems
+    if (name_count > 0) {
+        qsort(names, name_count, sizeof(char*), compare_names);
+    }
+    for (size_t i = 0; i < name_count; i++) {
+        char rom_path[CORPUS_PATH_SIZE];
+        struct stat st;
+        snprintf(rom_path, sizeof(rom_path), "%s/%s", path, names[i]);
+        if (result == 0 && stat(rom_path, &st) == 0 && S_ISREG(st.st_mode)) {
+            size_t size = 0;
+            const uint8_t* data = map_file(corpus, rom_path, &size);
+            if (data != NULL && add_rom(corpus, names[i], strlen(names[i]), data, size) != 0) {
+                result = -1;
+            }
+        }
+        free(names[i]);
+    }
+    free(names);
+
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint32_t read_u32_le(const uint8_t* data) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int open_pack(g2chip_corpus_t* corpus, const uint8_t* data, size_t size) {
+    uint32_t count = read_u32_le(&data[4]);
+    size_t offset = CORPUS_PACK_HEADER_SIZE;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (size - offset < 2) {
+            return -1;
+        }
+        size_t name_length = (size_t)data[offset] | ((size_t)data[offset + 1] << 8);
+        offset += 2;
+        if (size - offset < name_length + 4) {
+            return -1;
+        }
+        const char* name = (const char*)&data[offset];
+        offset += name_length;
+        size_t rom_size = read_u32_le(&data[offset]);
+        offset += 4;
+        if (size - offset < rom_size) {
+            return -1;
+        }
+        if (add_rom(corpus, name, name_length, &data[offset], rom_size) != 0) {
+            return -1;
+        }
+        offset += rom_size;
+    }
+
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int deduplicate(g2chip_corpus_t* corpus) {
+    size_t slot_count = 1;
+    while (slot_count < corpus->rom_count * 2) {
+        slot_count *= 2;
+    }
+    size_t* slots = (size_t*)calloc(slot_count, sizeof(size_t));  // ROM index + 1, 0 marks an empty slot
+    if (slots == NULL) {
+        return -1;
+    }
+
+    size_t unique_count = 0;
+    for (size_t i = 0; i < corpus->rom_count; i++) {
+        g2chip_corpus_rom_t rom = corpus->roms[i];
+        size_t slot = (size_t)rom.hash & (slot_count - 1);
+        int duplicate = 0;
+        while (slots[slot] != 0) {
+            const g2chip_corpus_rom_t* other = &corpus->roms[slots[slot] - 1];
+            if (other->hash == rom.hash && other->size == rom.size && memcmp(other->data, rom.data, rom.size) == 0) {
+                duplicate = 1;
+                break;
+            }
+            slot = (slot + 1) & (slot_count - 1);
+        }
+
+        if (duplicate) {
+            free((char*)rom.name);
+            corpus->duplicate_count++;
+        } else {
+            corpus->roms[unique_count] = rom;
+            slots[slot] = ++unique_count;
+        }
+    }
+    corpus->rom_count = unique_count;
+
+    free(slots);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+uint64_t g2chip_corpus_hash(const uint8_t* data, size_t size) {
+    uint64_t hash = CORPUS_FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= CORPUS_FNV_PRIME;
+    }
+    return hash;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_corpus_t* g2chip_corpus_open(const char* path) {
+    struct stat st;
+    if (path == NULL || stat(path, &st) != 0) {
+        return NULL;
+    }
+
+    g2chip_corpus_t* corpus = (g2chip_corpus_t*)calloc(1, sizeof(g2chip_corpus_t));
+    if (corpus == NULL) {
+        return NULL;
+    }
+
+    int result = -1;
+    if (S_ISDIR(st.st_mode)) {
+        result = open_directory(corpus, path);
+    } else {
+        size_t size = 0;
+        const uint8_t* data = map_file(corpus, path, &size);
+        if (data != NULL && size >= CORPUS_PACK_HEADER_SIZE && memcmp(data, G2CHIP_CORPUS_PACK_MAGIC, 4) == 0) {
+            result = open_pack(corpus, data, size);
+        } else if (data != NULL) {
+            result = add_rom(corpus, path, strlen(path), data, size);
+        }
+    }
+
+    if (result != 0 || deduplicate(corpus) != 0) {
+        g2chip_corpus_close(corpus);
+        return NULL;
+    }
+
+    return corpus;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_corpus_close(g2chip_corpus_t* corpus) {
+    if (corpus == NULL) {
+        return;
+    }
+
+    for (size_t i = 0; i < corpus->rom_count; i++) {
+        free((char*)corpus->roms[i].name);
+    }
+    for (size_t i = 0; i < corpus->mapping_count; i++) {
+        munmap(corpus->mappings[i].address, corpus->mappings[i].size);
+    }
+    free(corpus->roms);
+    free(corpus->mappings);
+    free(corpus);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+size_t g2chip_corpus_count(const g2chip_corpus_t* corpus) {
+    return (corpus != NULL) ? corpus->rom_count : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+size_t g2chip_corpus_duplicate_count(const g2chip_corpus_t* corpus) {
+    return (corpus != NULL) ? corpus->duplicate_count : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+const g2chip_corpus_rom_t* g2chip_corpus_get(const g2chip_corpus_t* corpus, size_t index) {
+    if (corpus == NULL || index >= corpus->rom_count) {
+        return NULL;
+    }
+    return &corpus->roms[index];
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void write_u32_le(FILE* file, uint32_t value) {
+    uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    fwrite(bytes, 1, sizeof(bytes), file);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_corpus_write_pack(const g2chip_corpus_t* corpus, const char* path) {
+    if (corpus == NULL || path == NULL) {
+        return -1;
+    }
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    fwrite(G2CHIP_CORPUS_PACK_MAGIC, 1, 4, file);
+    write_u32_le(file, (uint32_t)corpus->rom_count);
+    for (size_t i = 0; i < corpus->rom_count; i++) {
+        const g2chip_corpus_rom_t* rom = &corpus->roms[i];
+        size_t name_length = strlen(rom->name);
+        if (name_length > 0xFFFF) {
+            name_length = 0xFFFF;
+        }
+        uint8_t length_bytes[2] = {(uint8_t)name_length, (uint8_t)(name_length >> 8)};
+        fwrite(length_bytes, 1, sizeof(length_bytes), file);
+        fwrite(rom->name, 1, name_length, file);
+        write_u32_le(file, (uint32_t)rom->size);
+        fwrite(rom->data, 1, rom->size, file);
+    }
+
+    int result = ferror(file) ? -1 : 0;
+    fclose(file);
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t* cursor_take(cache_cursor_t* cursor, size_t size) {
+    if (cursor->error || cursor->size - cursor->offset < size) {
+        cursor->error = 1;
+        return NULL;
+    }
+    uint8_t* data = &cursor->data[cursor->offset];
+    cursor->offset += size;
+    return data;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cursor_put(cache_cursor_t* cursor, uint64_t value, size_t size) {
+    uint8_t* data = cursor_take(cursor, size);
+    for (size_t i = 0; data != NULL && i < size; i++) {
+        data[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t cursor_get(cache_cursor_t* cursor, size_t size) {
+    const uint8_t* data = cursor_take(cursor, size);
+    uint64_t value = 0;
+    for (size_t i = 0; data != NULL && i < size; i++) {
+        value |= (uint64_t)data[i] << (8 * i);
+    }
+    return value;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* Callers index analysis->map with cached addresses, so a corrupt record must not yield one outside memory */
+static uint16_t cursor_get_address(cache_cursor_t* cursor) {
+    uint64_t address = cursor_get(cursor, 2);
+    if (address >= G2CHIP_MEMORY_SIZE) {
+        cursor->error = 1;
+        return 0;
+    }
+    return (uint16_t)address;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void cache_path(char* path, size_t size, const char* cache_dir, uint64_t hash) {
+    snprintf(path, size, "%s/%016llx.g2ca", cache_dir, (unsigned long long)hash);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t* analysis_counters(g2chip_analysis_t* analysis, size_t index) {
+    size_t* const counters[] = {
+        &analysis->code_size,     &analysis->instruction_count,      &analysis->jump_count,
+        &analysis->call_count,    &analysis->skip_count,             &analysis->indirect_jump_count,
+        &analysis->invalid_count, &analysis->unresolved_write_count, &analysis->self_modifying_count,
+    };
+    return counters[index];
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void serialize_info(cache_cursor_t* cursor, const g2chip_corpus_rom_t* rom, const g2chip_corpus_info_t* info) {
+    g2chip_analysis_t* analysis = info->analysis;
+
+    memcpy(cursor_take(cursor, 4), G2CHIP_CORPUS_CACHE_MAGIC, 4);
+    cursor_put(cursor, G2CHIP_CORPUS_CACHE_VERSION, 4);
+    cursor_put(cursor, G2CHIP_ANALYSIS_VERSION, 4);
+    cursor_put(cursor, G2CHIP_MEMORY_SIZE, 4);
+    cursor_put(cursor, rom->size, 4);
+    cursor_put(cursor, rom->hash, 8);
+    cursor_put(cursor, (uint32_t)info->quirks.memory_wrap, 4);
+    for (size_t i = 0; i < 9; i++) {
+        cursor_put(cursor, *analysis_counters(analysis, i), 4);
+    }
+    cursor_put(cursor, analysis->block_count, 4);
+    cursor_put(cursor, info->instruction_count, 4);
+
+    memcpy(cursor_take(cursor, G2CHIP_MEMORY_SIZE), analysis->map, G2CHIP_MEMORY_SIZE);
+    for (size_t i = 0; i < G2CHIP_ANALYSIS_PAGE_WORD_COUNT; i++) {
+        cursor_put(cursor, analysis->written_pages[i], 4);
+    }
+    for (size_t i = 0; i < analysis->block_count; i++) {
+        const g2chip_analysis_block_t* block = &analysis->blocks[i];
+        cursor_put(cursor, block->start, 2);
+        cursor_put(cursor, block->last, 2);
+        cursor_put(cursor, block->successors[0], 2);
+        cursor_put(cursor, block->successors[1], 2);
+        cursor_put(cursor, block->successor_count, 1);
+    }
+    for (size_t i = 0; i < info->instruction_count; i++) {
+        cursor_put(cursor, info->instructions[i].address, 2);
+        cursor_put(cursor, info->instructions[i].raw, 2);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int deserialize_info(cache_cursor_t* cursor, const g2chip_corpus_rom_t* rom, g2chip_corpus_info_t* info) {
+    const uint8_t* magic = cursor_take(cursor, 4);
+    if (magic == NULL || memcmp(magic, G2CHIP_CORPUS_CACHE_MAGIC, 4) != 0 ||
+        cursor_get(cursor, 4) != G2CHIP_CORPUS_CACHE_VERSION || cursor_get(cursor, 4) != G2CHIP_ANALYSIS_VERSION ||
+        cursor_get(cursor, 4) != G2CHIP_MEMORY_SIZE || cursor_get(cursor, 4) != rom->size ||
+        cursor_get(cursor, 8) != rom->hash) {
+        return -1;
+    }
+
+    g2chip_analysis_t* analysis = (g2chip_analysis_t*)calloc(1, sizeof(g2chip_analysis_t));
+    if (analysis == NULL) {
+        return -1;
+    }
+    info->analysis = analysis;
+    analysis->rom_size = rom->size;
+    uint64_t memory_wrap = cursor_get(cursor, 4);
+    info->quirks.memory_wrap = (g2chip_memory_wrap_t)memory_wrap;
+    for (size_t i = 0; i < 9; i++) {
+        *analysis_counters(analysis, i) = (size_t)cursor_get(cursor, 4);
+    }
+    size_t block_count = (size_t)cursor_get(cursor, 4);
+    size_t instruction_count = (size_t)cursor_get(cursor, 4);
+    if (cursor->error || memory_wrap > G2CHIP_MEMORY_WRAP_GUARD || block_count > G2CHIP_MEMORY_SIZE ||
+        instruction_count > G2CHIP_MEMORY_SIZE ||
+        cursor->size - cursor->offset != G2CHIP_MEMORY_SIZE + G2CHIP_ANALYSIS_PAGE_WORD_COUNT * 4 +
+                                             block_count * CACHE_BLOCK_SIZE +
+                                             instruction_count * CACHE_INSTRUCTION_SIZE) {
+        return -1;
+    }
+
+    analysis->blocks = (g2chip_analysis_block_t*)calloc(block_count + 1, sizeof(g2chip_analysis_block_t));
+    info->instructions =
+        (g2chip_corpus_instruction_t*)calloc(instruction_count + 1, sizeof(g2chip_corpus_instruction_t));
+    if (analysis->blocks == NULL || info->instructions == NULL) {
+        return -1;
+    }
+
+    memcpy(analysis->map, cursor_take(cursor, G2CHIP_MEMORY_SIZE), G2CHIP_MEMORY_SIZE);
+    for (size_t i = 0; i < G2CHIP_ANALYSIS_PAGE_WORD_COUNT; i++) {
+        analysis->written_pages[i] = (uint32_t)cursor_get(cursor, 4);
+    }
+    for (size_t i = 0; i < block_count; i++) {
+        g2chip_analysis_block_t* block = &analysis->blocks[i];
+        block->start = cursor_get_address(cursor);
+        block->last = cursor_get_address(cursor);
+        block->successors[0] = cursor_get_address(cursor);
+        block->successors[1] = cursor_get_address(cursor);
+        block->successor_count = (uint8_t)cursor_get(cursor, 1);
+        if (block->successor_count > 2) {
+            cursor->error = 1;
+        }
+    }
+    analysis->block_count = block_count;
+    for (size_t i = 0; i < instruction_count; i++) {
+        info->instructions[i].address = cursor_get_address(cursor);
+        info->instructions[i].raw = (uint16_t)cursor_get(cursor, 2);
+    }
+    info->instruction_count = instruction_count;
+
+    return cursor->error ? -1 : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int read_cached_info(const char* cache_dir, const g2chip_corpus_rom_t* rom, g2chip_corpus_info_t* info) {
+    char path[CORPUS_PATH_SIZE];
+    cache_path(path, sizeof(path), cache_dir, rom->hash);
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    cache_cursor_t cursor = {0};
+    if (file_size > 0) {
+        cursor.data = (uint8_t*)malloc((size_t)file_size);
+        cursor.size = (cursor.data != NULL) ? fread(cursor.data, 1, (size_t)file_size, file) : 0;
+    }
+    fclose(file);
+
+    int result = (cursor.data != NULL) ? deserialize_info(&cursor, rom, info) : -1;
+    free(cursor.data);
+    if (result != 0) {
+        g2chip_corpus_free_info(info);
+        info->hash = rom->hash;
+    }
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t rom_byte(const g2chip_corpus_rom_t* rom, size_t address) {
+    address &= G2CHIP_ADDRESS_MASK;
+    if (address < G2CHIP_PROGRAM_START_ADDRESS || address - G2CHIP_PROGRAM_START_ADDRESS >= rom->size) {
+        return 0;
+    }
+    return rom->data[address - G2CHIP_PROGRAM_START_ADDRESS];
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int compute_info(const g2chip_corpus_rom_t* rom, g2chip_corpus_info_t* info) {
+    info->quirks.memory_wrap = G2CHIP_MEMORY_WRAP_AROUND;  // Nothing in the ROM tells the quirks, callers override
+    info->analysis = g2chip_analysis_create(rom->data, rom->size);
+    if (info->analysis == NULL) {
+        return -1;
+    }
+    info->instructions = (g2chip_corpus_instruction_t*)calloc(info->analysis->instruction_count + 1,
+                                                              sizeof(g2chip_corpus_instruction_t));
+    if (info->instructions == NULL) {
+        return -1;
+    }
+
+    for (size_t address = 0; address < G2CHIP_MEMORY_SIZE; address++) {
+        if (info->analysis->map[address] & G2CHIP_ANALYSIS_INSTRUCTION) {
+            g2chip_corpus_instruction_t* instruction = &info->instructions[info->instruction_count++];
+            instruction->address = (uint16_t)address;
+            instruction->raw = (uint16_t)((rom_byte(rom, address) << 8) | rom_byte(rom, address + 1));
+        }
+    }
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_corpus_load_info(const char* cache_dir, const g2chip_corpus_rom_t* rom, g2chip_corpus_info_t* info) {
+    if (rom == NULL || info == NULL) {
+        return -1;
+    }
+
+    memset(info, 0, sizeof(*info));
+    info->hash = rom->hash;
+    if (cache_dir != NULL && read_cached_info(cache_dir, rom, info) == 0) {
+        return 1;
+    }
+
+    if (compute_info(rom, info) != 0) {
+        g2chip_corpus_free_info(info);
+        return -1;
+    }
+    if (cache_dir != NULL) {
+        g2chip_corpus_save_info(cache_dir, rom, info);  // Best effort, the next run recomputes on failure
+    }
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_corpus_save_info(const char* cache_dir, const g2chip_corpus_rom_t* rom, const g2chip_corpus_info_t* info) {
+    if (cache_dir == NULL || rom == NULL || info == NULL || info->analysis == NULL) {
+        return -1;
+    }
+
+    cache_cursor_t cursor = {0};
+    cursor.size = CACHE_FIXED_SIZE + info->analysis->block_count * CACHE_BLOCK_SIZE +
+                  info->instruction_count * CACHE_INSTRUCTION_SIZE;
+    cursor.data = (uint8_t*)malloc(cursor.size);
+    if (cursor.data == NULL) {
+        return -1;
+    }
+    serialize_info(&cursor, rom, info);
+
+    // Write to a private file and rename it so concurrent jobs never observe a partial record
+    char path[CORPUS_PATH_SIZE];
+    char temporary_path[CORPUS_PATH_SIZE + 32];
+    cache_path(path, sizeof(path), cache_dir, rom->hash);
+    snprintf(temporary_path, sizeof(temporary_path), "%s.%ld.tmp", path, (long)getpid());
+
+    int result = -1;
+    FILE* file = fopen(temporary_path, "wb");
+    if (file != NULL && !cursor.error) {
+        size_t written = fwrite(cursor.data, 1, cursor.offset, file);
+        result = (written == cursor.offset) ? 0 : -1;
+    }
+    if (file != NULL) {
+        if (fclose(file) != 0) {
+            result = -1;
+        }
+        if (result == 0 && rename(temporary_path, path) != 0) {
+            result = -1;
+        }
+        if (result != 0) {
+            remove(temporary_path);
+        }
+    }
+
+    free(cursor.data);
+    return result;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_corpus_free_info(g2chip_corpus_info_t* info) {
+    if (info != NULL) {
+        g2chip_analysis_destroy(info->analysis);
+        free(info->instructions);
+        memset(info, 0, sizeof(*info));
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
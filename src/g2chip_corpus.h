@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#ifndef G2CHIP_CORPUS_H
+#define G2CHIP_CORPUS_H
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "g2chip.h"
+#include "g2chip_analysis.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+/*
+ * Pack file layout (all integers little-endian):
+ *   header  "G2PK", u32 rom count
+ *   entry   u16 name length, name bytes, u32 ROM size, ROM bytes
+ */
+#define G2CHIP_CORPUS_PACK_MAGIC "G2PK"
+#define G2CHIP_CORPUS_CACHE_MAGIC "G2CA"
+#define G2CHIP_CORPUS_CACHE_VERSION 2 /**< Records also carry G2CHIP_ANALYSIS_VERSION, a change in either drops them */
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_corpus g2chip_corpus_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_corpus_rom {
+    const char* name;    /**< File name, or entry name inside a pack */
+    const uint8_t* data; /**< Points into the mapping, valid until g2chip_corpus_close() */
+    size_t size;
+    uint64_t hash; /**< FNV-1a of the ROM content */
+} g2chip_corpus_rom_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_corpus_instruction {
+    uint16_t address;
+    uint16_t raw;
+} g2chip_corpus_instruction_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_corpus_info {
+    uint64_t hash;
+    g2chip_quirks_t quirks; /**< Stored override for config.quirks, not derived: new entries get the defaults */
+    g2chip_analysis_t* analysis;
+    g2chip_corpus_instruction_t* instructions; /**< Reachable instructions in address order */
+    size_t instruction_count;
+} g2chip_corpus_info_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+/** Map a directory of ROMs, a pack file or a single ROM file; identical ROMs are kept once */
+g2chip_corpus_t* g2chip_corpus_open(const char* path);
+void g2chip_corpus_close(g2chip_corpus_t* corpus);
+size_t g2chip_corpus_count(const g2chip_corpus_t* corpus);
+size_t g2chip_corpus_duplicate_count(const g2chip_corpus_t* corpus);
+const g2chip_corpus_rom_t* g2chip_corpus_get(const g2chip_corpus_t* corpus, size_t index);
+int g2chip_corpus_write_pack(const g2chip_corpus_t* corpus, const char* path);
+uint64_t g2chip_corpus_hash(const uint8_t* data, size_t size);
+/*--------------------------------------------------------------------------------------------------------------------*/
+/**
+ * Fill info for rom from <cache_dir>/<hash>.g2ca, analyzing the ROM and storing the result on a miss.
+ * Returns 1 on a cache hit, 0 when the info was computed and -1 on error. A NULL cache_dir disables the cache.
+ */
+int g2chip_corpus_load_info(const char* cache_dir, const g2chip_corpus_rom_t* rom, g2chip_corpus_info_t* info);
+/**
+ * Persist info, e.g. after setting the quirks a ROM needs. The analysis is unaffected by them: it always assumes
+ * G2CHIP_MEMORY_WRAP_AROUND, whose written pages are a superset of those under G2CHIP_MEMORY_WRAP_GUARD.
+ */
+int g2chip_corpus_save_info(const char* cache_dir, const g2chip_corpus_rom_t* rom, const g2chip_corpus_info_t* info);
+void g2chip_corpus_free_info(g2chip_corpus_info_t* info);
+/*--------------------------------------------------------------------------------------------------------------------*/
+#endif  // G2CHIP_CORPUS_H
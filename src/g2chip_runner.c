@@ -0,0 +1,229 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
+#include "g2chip_runner.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define RUNNER_BUFFER_COUNT 3
+#define RUNNER_BUFFER_INDEX_MASK 0x03
+#define RUNNER_BUFFER_FRESH 0x04 /**< Set in middle_buffer when it holds a frame the reader has not taken yet */
+#define RUNNER_KEY_QUEUE_SIZE 64 /**< Power of two */
+#define RUNNER_KEY_PRESSED 0x10
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_runner {
+    g2chip_t* chip;
+    uint32_t instructions_per_frame;
+    uint32_t frame_period_us;
+    pthread_t thread;
+    atomic_int running;
+
+    /* Triple buffer: the emulation thread owns back_buffer, the frontend owns front_buffer */
+    uint8_t frames[RUNNER_BUFFER_COUNT][G2CHIP_RUNNER_FRAME_SIZE];
+    atomic_uint middle_buffer;
+    unsigned back_buffer;
+    unsigned front_buffer;
+
+    /* Single-producer (frontend) single-consumer (emulation thread) key event queue */
+    uint8_t key_queue[RUNNER_KEY_QUEUE_SIZE];
+    atomic_size_t key_queue_head;
+    atomic_size_t key_queue_tail;
+    uint16_t keypad;
+    uint16_t pending_release; /**< Keys pressed and released between two frames, released after one frame */
+} g2chip_runner_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint64_t get_time_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint32_t get_time_ms_impl(void) {
+    return (uint32_t)(get_time_us() / 1000);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void sleep_until_us(uint64_t deadline_us) {
+    uint64_t now_us = get_time_us();
+    if (deadline_us <= now_us) {
+        return;
+    }
+    uint64_t delay_us = deadline_us - now_us;
+    struct timespec ts = {
+        .tv_sec = (time_t)(delay_us / 1000000),
+        .tv_nsec = (long)(delay_us % 1000000) * 1000,
+    };
+    nanosleep(&ts, NULL);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void apply_key_events(g2chip_runner_t* runner) {
+    size_t tail = atomic_load_explicit(&runner->key_queue_tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&runner->key_queue_head, memory_order_acquire);
+    if (tail == head && runner->pending_release == 0) {
+        return;
+    }
+
+    // Releases held back last frame take effect now that the program has run with the key down. The chip sees them
+    // before any new press, so pressing the same key again this frame still counts as a press for FX0A.
+    if (runner->pending_release != 0) {
+        runner->keypad &= (uint16_t)~runner->pending_release;
+        runner->pending_release = 0;
+        g2chip_set_keypad(runner->chip, runner->keypad);
+    }
+
+    uint16_t pressed = 0;
+    for (; tail != head; tail++) {
+        uint8_t event = runner->key_queue[tail & (RUNNER_KEY_QUEUE_SIZE - 1)];
+        uint16_t mask = (uint16_t)(1 << (event & 0x0F));
+        if (event & RUNNER_KEY_PRESSED) {
+            runner->keypad |= mask;
+            runner->pending_release &= (uint16_t)~mask;
+            pressed |= mask;
+        } else if (pressed & mask) {
+            runner->pending_release |= mask;  // Tapped within one frame, keep it down for this frame
+        } else {
+            runner->keypad &= (uint16_t)~mask;
+        }
+    }
+    atomic_store_explicit(&runner->key_queue_tail, tail, memory_order_release);
+    g2chip_set_keypad(runner->chip, runner->keypad);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void publish_frame(g2chip_runner_t* runner) {
+    memcpy(runner->frames[runner->back_buffer], g2chip_get_display(runner->chip), G2CHIP_RUNNER_FRAME_SIZE);
+    unsigned previous = atomic_exchange_explicit(&runner->middle_buffer, runner->back_buffer | RUNNER_BUFFER_FRESH,
+                                                 memory_order_acq_rel);
+    runner->back_buffer = previous & RUNNER_BUFFER_INDEX_MASK;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void* runner_thread(void* argument) {
+    g2chip_runner_t* runner = (g2chip_runner_t*)argument;
+    uint64_t next_frame_us = get_time_us();
+
+    while (atomic_load_explicit(&runner->running, memory_order_acquire)) {
+        apply_key_events(runner);
+        for (uint32_t i = 0; i < runner->instructions_per_frame; i++) {
+            g2chip_step(runner->chip);
+        }
+        publish_frame(runner);
+
+        next_frame_us += runner->frame_period_us;
+        uint64_t now_us = get_time_us();
+        if (next_frame_us + runner->frame_period_us < now_us) {
+            next_frame_us = now_us;  // Fell more than a frame behind, do not try to catch up
+        }
+        sleep_until_us(next_frame_us);
+    }
+
+    return NULL;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_runner_t* g2chip_runner_create(const g2chip_runner_config_t* config, const uint8_t* rom_data, size_t size) {
+    if (config == NULL) {
+        return NULL;
+    }
+
+    g2chip_runner_t* runner = (g2chip_runner_t*)calloc(1, sizeof(g2chip_runner_t));
+    if (runner == NULL) {
+        return NULL;
+    }
+
+    g2chip_config_t chip_config = config->chip;
+    chip_config.key_is_pressed = NULL;
+    chip_config.key_wait_press = NULL;
+    if (chip_config.get_time_ms == NULL) {
+        chip_config.get_time_ms = get_time_ms_impl;
+    }
+
+    runner->chip = g2chip_create(&chip_config);
+    if (runner->chip == NULL || g2chip_load_rom(runner->chip, rom_data, size) != 0) {
+        g2chip_runner_destroy(runner);
+        return NULL;
+    }
+
+    runner->instructions_per_frame = config->instructions_per_frame;
+    if (runner->instructions_per_frame == 0) {
+        runner->instructions_per_frame = G2CHIP_RUNNER_DEFAULT_INSTRUCTIONS_PER_FRAME;
+    }
+    runner->frame_period_us = config->frame_period_us;
+    if (runner->frame_period_us == 0) {
+        runner->frame_period_us = G2CHIP_RUNNER_DEFAULT_FRAME_PERIOD_US;
+    }
+
+    runner->front_buffer = 0;
+    atomic_init(&runner->middle_buffer, 1);
+    runner->back_buffer = 2;
+    atomic_init(&runner->running, 0);
+    atomic_init(&runner->key_queue_head, 0);
+    atomic_init(&runner->key_queue_tail, 0);
+
+    return runner;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_runner_destroy(g2chip_runner_t* runner) {
+    if (runner != NULL) {
+        g2chip_runner_stop(runner);
+        g2chip_destroy(runner->chip);
+        free(runner);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_runner_start(g2chip_runner_t* runner) {
+    if (runner == NULL || atomic_load(&runner->running)) {
+        return -1;
+    }
+
+    atomic_store(&runner->running, 1);
+    if (pthread_create(&runner->thread, NULL, runner_thread, runner) != 0) {
+        atomic_store(&runner->running, 0);
+        return -1;
+    }
+
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+void g2chip_runner_stop(g2chip_runner_t* runner) {
+    if (runner == NULL || !atomic_load(&runner->running)) {
+        return;
+    }
+
+    atomic_store(&runner->running, 0);
+    pthread_join(runner->thread, NULL);
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_runner_set_key(g2chip_runner_t* runner, uint8_t key, uint8_t pressed) {
+    if (runner == NULL || key > 0x0F) {
+        return -1;
+    }
+
+    size_t head = atomic_load_explicit(&runner->key_queue_head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&runner->key_queue_tail, memory_order_acquire);
+    if (head - tail == RUNNER_KEY_QUEUE_SIZE) {
+        return -1;
+    }
+
+    runner->key_queue[head & (RUNNER_KEY_QUEUE_SIZE - 1)] = key | (pressed ? RUNNER_KEY_PRESSED : 0);
+    atomic_store_explicit(&runner->key_queue_head, head + 1, memory_order_release);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+int g2chip_runner_acquire_frame(g2chip_runner_t* runner, const uint8_t** frame) {
+    if (runner == NULL || frame == NULL) {
+        return -1;
+    }
+
+    int is_new = 0;
+    if (atomic_load_explicit(&runner->middle_buffer, memory_order_relaxed) & RUNNER_BUFFER_FRESH) {
+        unsigned previous =
+            atomic_exchange_explicit(&runner->middle_buffer, runner->front_buffer, memory_order_acq_rel);
+        runner->front_buffer = previous & RUNNER_BUFFER_INDEX_MASK;
+        is_new = 1;
+    }
+
+    *frame = runner->frames[runner->front_buffer];
+    return is_new;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
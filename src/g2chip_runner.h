@@ -0,0 +1,33 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#ifndef G2CHIP_RUNNER_H
+#define G2CHIP_RUNNER_H
+/*--------------------------------------------------------------------------------------------------------------------*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "g2chip.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define G2CHIP_RUNNER_DEFAULT_INSTRUCTIONS_PER_FRAME 11
+#define G2CHIP_RUNNER_DEFAULT_FRAME_PERIOD_US 16667
+#define G2CHIP_RUNNER_FRAME_SIZE (G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT)
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_runner g2chip_runner_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct g2chip_runner_config {
+    g2chip_config_t chip; /**< Core callbacks, called on the emulation thread; key callbacks are ignored */
+    uint32_t instructions_per_frame; /**< 0 selects G2CHIP_RUNNER_DEFAULT_INSTRUCTIONS_PER_FRAME */
+    uint32_t frame_period_us;        /**< 0 selects G2CHIP_RUNNER_DEFAULT_FRAME_PERIOD_US (60 Hz) */
+} g2chip_runner_config_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+g2chip_runner_t* g2chip_runner_create(const g2chip_runner_config_t* config, const uint8_t* rom_data, size_t size);
+void g2chip_runner_destroy(g2chip_runner_t* runner);
+int g2chip_runner_start(g2chip_runner_t* runner);
+void g2chip_runner_stop(g2chip_runner_t* runner);
+/** Queue a key event for the emulation thread, returns -1 when the queue is full */
+int g2chip_runner_set_key(g2chip_runner_t* runner, uint8_t key, uint8_t pressed);
+/** Point frame at the newest frame, returns 1 if a frame (possibly identical) was published since the previous call */
+int g2chip_runner_acquire_frame(g2chip_runner_t* runner, const uint8_t** frame);
+/*--------------------------------------------------------------------------------------------------------------------*/
+#endif  // G2CHIP_RUNNER_H
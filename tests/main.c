@@ -0,0 +1,428 @@
+/*--------------------------------------------------------------------------------------------------------------------*/
+/* SPDX-License-Identifier: MIT */
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "g2chip.h"
+#include "g2chip_analysis.h"
+#include "g2chip_capture.h"
+#include "g2chip_corpus.h"
+#include "g2chip_runner.h"
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define CHECK(condition)                                                         \
+    do {                                                                         \
+        if (!(condition)) {                                                      \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            return -1;                                                           \
+        }                                                                        \
+    } while (0)
+/*--------------------------------------------------------------------------------------------------------------------*/
+typedef struct test_case {
+    const char* name;
+    int (*run)(void);
+} test_case_t;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t count_frame_pixels(const uint8_t* display) {
+    size_t count = 0;
+    for (size_t i = 0; i < G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT; i++) {
+        count += display[i];
+    }
+    return count;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static size_t count_lit_pixels(const g2chip_t* chip) {
+    return count_frame_pixels(g2chip_get_display(chip));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static void run_steps(g2chip_t* chip, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        g2chip_step(chip);
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_shorter_rom_clears_previous(void) {
+    // CLS; I = font '0'; draw 5 rows. The second ROM only keeps the CLS, the old draw must not survive the load.
+    static const uint8_t long_rom[] = {0x00, 0xE0, 0xA0, 0x50, 0xD0, 0x05};
+    static const uint8_t short_rom[] = {0x00, 0xE0};
+    g2chip_config_t config = {0};
+    g2chip_t* chip = g2chip_create(&config);
+    CHECK(chip != NULL);
+
+    CHECK(g2chip_load_rom(chip, long_rom, sizeof(long_rom)) == 0);
+    run_steps(chip, 3);
+    CHECK(count_lit_pixels(chip) > 0);
+
+    g2chip_reset(chip);
+    CHECK(g2chip_load_rom(chip, short_rom, sizeof(short_rom)) == 0);
+    run_steps(chip, 3);
+    size_t lit = count_lit_pixels(chip);
+
+    g2chip_destroy(chip);
+    CHECK(lit == 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_held_key_satisfies_one_key_wait(void) {
+    // Wait for a key twice, then draw font '0' and spin
+    static const uint8_t rom[] = {0xF0, 0x0A, 0xF1, 0x0A, 0xA0, 0x50, 0xD0, 0x05, 0x12, 0x08};
+    g2chip_config_t config = {0};
+    g2chip_t* chip = g2chip_create(&config);
+    CHECK(chip != NULL);
+    CHECK(g2chip_load_rom(chip, rom, sizeof(rom)) == 0);
+
+    g2chip_set_keypad(chip, 1 << 0x5);
+    run_steps(chip, 8);
+    size_t lit_while_held = count_lit_pixels(chip);
+
+    g2chip_set_keypad(chip, 0);
+    g2chip_set_keypad(chip, 1 << 0x5);
+    run_steps(chip, 8);
+    size_t lit_after_press = count_lit_pixels(chip);
+
+    g2chip_destroy(chip);
+    CHECK(lit_while_held == 0);
+    CHECK(lit_after_press > 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint16_t polled_keypad = 0;
+/*--------------------------------------------------------------------------------------------------------------------*/
+static uint8_t key_is_pressed_impl(uint8_t key) {
+    return (polled_keypad >> key) & 0x01;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_key_wait_polls_key_callback(void) {
+    // Wait for a key twice, then draw font '0' and spin
+    static const uint8_t rom[] = {0xF0, 0x0A, 0xF1, 0x0A, 0xA0, 0x50, 0xD0, 0x05, 0x12, 0x08};
+    g2chip_config_t config = {0};
+    config.key_is_pressed = key_is_pressed_impl;
+    g2chip_t* chip = g2chip_create(&config);
+    CHECK(chip != NULL);
+    CHECK(g2chip_load_rom(chip, rom, sizeof(rom)) == 0);
+
+    polled_keypad = 1 << 0x5;
+    run_steps(chip, 8);
+    size_t lit_while_held = count_lit_pixels(chip);
+
+    polled_keypad = 0;
+    run_steps(chip, 1);
+    polled_keypad = 1 << 0x5;
+    run_steps(chip, 8);
+    size_t lit_after_press = count_lit_pixels(chip);
+
+    g2chip_destroy(chip);
+    CHECK(lit_while_held == 0);
+    CHECK(lit_after_press > 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int check_all_pages_written(const uint8_t* rom, size_t size) {
+    g2chip_analysis_t* analysis = g2chip_analysis_create(rom, size);
+    CHECK(analysis != NULL);
+    size_t written = 0;
+    for (size_t page = 0; page < G2CHIP_ANALYSIS_PAGE_COUNT; page++) {
+        written += g2chip_analysis_page_is_written(analysis, (uint16_t)(page * G2CHIP_ANALYSIS_PAGE_SIZE));
+    }
+    g2chip_analysis_destroy(analysis);
+    CHECK(written == G2CHIP_ANALYSIS_PAGE_COUNT);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_indirect_jump_writes_are_conservative(void) {
+    // V0 = 0; jump V0 + 0x206, which is only reached through BNNN and overwrites page 0x200
+    static const uint8_t rom[] = {0x60, 0x00, 0xB2, 0x06, 0x12, 0x04, 0xA2, 0x00, 0xF1, 0x55, 0x12, 0x0A};
+    return check_all_pages_written(rom, sizeof(rom));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_invalid_opcode_writes_are_conservative(void) {
+    // The core steps over the unimplemented 0123 and then overwrites page 0x200
+    static const uint8_t rom[] = {0x60, 0x00, 0x01, 0x23, 0xA2, 0x00, 0xF1, 0x55, 0x12, 0x08};
+    return check_all_pages_written(rom, sizeof(rom));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_invalid_opcode_is_stepped_over(void) {
+    // V0 = 0; unimplemented 0123; I = 0x300; store V0-V1; spin. Everything past 0123 still runs.
+    static const uint8_t rom[] = {0x60, 0x00, 0x01, 0x23, 0xA3, 0x00, 0xF1, 0x55, 0x12, 0x08};
+    g2chip_analysis_t* analysis = g2chip_analysis_create(rom, sizeof(rom));
+    CHECK(analysis != NULL);
+    size_t instruction_count = analysis->instruction_count;
+    size_t data_size = analysis->rom_size - analysis->code_size;
+    int classified = strcmp(g2chip_analysis_classify(analysis), "invalid-opcodes") == 0;
+    g2chip_analysis_destroy(analysis);
+    CHECK(instruction_count == 5);
+    CHECK(data_size == 0);
+    CHECK(classified);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_unbalanced_return_writes_are_conservative(void) {
+    // The core steps over a RET on an empty stack and then overwrites page 0x200
+    static const uint8_t rom[] = {0x00, 0xEE, 0xA2, 0x00, 0xF1, 0x55, 0x12, 0x06};
+    return check_all_pages_written(rom, sizeof(rom));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_self_modifying_writes_are_conservative(void) {
+    // Rewrites 0x210 into A500 F155 and jumps there, so page 0x500 is written by code the analysis never sees
+    static const uint8_t rom[] = {0x60, 0xA5, 0x61, 0x00, 0x62, 0xF1, 0x63, 0x55, 0xA2, 0x10, 0xF3,
+                                  0x55, 0x12, 0x10, 0x00, 0x00, 0x00, 0xE0, 0x00, 0xE0, 0x12, 0x14};
+    return check_all_pages_written(rom, sizeof(rom));
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int patch_file(const char* path, long offset, const uint8_t* bytes, size_t size) {
+    FILE* file = fopen(path, "r+b");
+    CHECK(file != NULL);
+    if (offset < 0) {
+        fseek(file, offset, SEEK_END);
+    } else {
+        fseek(file, offset, SEEK_SET);
+    }
+    size_t written = fwrite(bytes, 1, size, file);
+    fclose(file);
+    CHECK(written == size);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int load_cached_info(const char* cache_dir, const g2chip_corpus_rom_t* rom) {
+    g2chip_corpus_info_t info;
+    int loaded = g2chip_corpus_load_info(cache_dir, rom, &info);
+    size_t out_of_range = 0;
+    for (size_t i = 0; loaded >= 0 && i < info.instruction_count; i++) {
+        size_t address = info.instructions[i].address;
+        out_of_range += address >= G2CHIP_MEMORY_SIZE;
+    }
+    g2chip_corpus_free_info(&info);
+    CHECK(out_of_range == 0);
+    return loaded;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_corpus_cache_rejects_stale_records(void) {
+    static const uint8_t rom[] = {0xA0, 0x50, 0xD0, 0x05, 0x12, 0x04};
+    static const uint8_t old_analysis_version[] = {G2CHIP_ANALYSIS_VERSION - 1, 0, 0, 0};
+    static const uint8_t bad_address[] = {0xFF, 0xFF};
+    char cache_dir[] = "/tmp/g2chip-cache-XXXXXX";
+    char rom_path[64];
+    char record_path[96];
+    CHECK(mkdtemp(cache_dir) != NULL);
+    snprintf(rom_path, sizeof(rom_path), "%s/rom.ch8", cache_dir);
+    FILE* rom_file = fopen(rom_path, "wb");
+    CHECK(rom_file != NULL);
+    fwrite(rom, 1, sizeof(rom), rom_file);
+    fclose(rom_file);
+
+    g2chip_corpus_t* corpus = g2chip_corpus_open(rom_path);
+    const g2chip_corpus_rom_t* entry = g2chip_corpus_get(corpus, 0);
+    CHECK(entry != NULL);
+    snprintf(record_path, sizeof(record_path), "%s/%016llx.g2ca", cache_dir, (unsigned long long)entry->hash);
+
+    int first = load_cached_info(cache_dir, entry);
+    int second = load_cached_info(cache_dir, entry);
+    int after_version_change = -1;
+    int after_corruption = -1;
+    if (patch_file(record_path, 8, old_analysis_version, sizeof(old_analysis_version)) == 0) {
+        after_version_change = load_cached_info(cache_dir, entry);
+    }
+    if (patch_file(record_path, -4, bad_address, sizeof(bad_address)) == 0) {
+        after_corruption = load_cached_info(cache_dir, entry);
+    }
+
+    g2chip_corpus_close(corpus);
+    remove(record_path);
+    remove(rom_path);
+    rmdir(cache_dir);
+    CHECK(first == 0);
+    CHECK(second == 1);
+    CHECK(after_version_change == 0);
+    CHECK(after_corruption == (G2CHIP_MEMORY_SIZE > 0xFFFF ? 1 : 0));  // With 64K every 16-bit address is valid
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_runner_keeps_consecutive_taps(void) {
+    // Wait for a key twice, then draw font '0' and spin
+    static const uint8_t rom[] = {0xF0, 0x0A, 0xF1, 0x0A, 0xA0, 0x50, 0xD0, 0x05, 0x12, 0x08};
+    static const struct timespec poll_wait = {.tv_sec = 0, .tv_nsec = 1000000};
+    g2chip_runner_config_t config = {0};
+    config.frame_period_us = 50000;  // Long frames so the second tap lands in the frame after the first
+    g2chip_runner_t* runner = g2chip_runner_create(&config, rom, sizeof(rom));
+    CHECK(runner != NULL);
+    CHECK(g2chip_runner_start(runner) == 0);
+
+    const uint8_t* display = NULL;
+    nanosleep(&poll_wait, NULL);
+    g2chip_runner_acquire_frame(runner, &display);
+    g2chip_runner_set_key(runner, 0x5, 1);
+    g2chip_runner_set_key(runner, 0x5, 0);
+    for (int poll = 0; poll < 200 && g2chip_runner_acquire_frame(runner, &display) == 0; poll++) {
+        nanosleep(&poll_wait, NULL);
+    }
+    g2chip_runner_set_key(runner, 0x5, 1);
+    g2chip_runner_set_key(runner, 0x5, 0);
+
+    size_t lit = 0;
+    for (int poll = 0; poll < 400 && lit == 0; poll++) {
+        nanosleep(&poll_wait, NULL);
+        g2chip_runner_acquire_frame(runner, &display);
+        lit = count_frame_pixels(display);
+    }
+
+    g2chip_runner_destroy(runner);
+    CHECK(lit > 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_runner_keeps_key_tap(void) {
+    // Wait for a key, then draw font '0' and spin
+    static const uint8_t rom[] = {0xF0, 0x0A, 0xA0, 0x50, 0xD0, 0x05, 0x12, 0x06};
+    static const struct timespec frame_wait = {.tv_sec = 0, .tv_nsec = 1000000};
+    g2chip_runner_config_t config = {0};
+    config.frame_period_us = 1000;
+    g2chip_runner_t* runner = g2chip_runner_create(&config, rom, sizeof(rom));
+    CHECK(runner != NULL);
+    CHECK(g2chip_runner_start(runner) == 0);
+
+    // Press and release back to back so both events land in the same frame
+    g2chip_runner_set_key(runner, 0x5, 1);
+    g2chip_runner_set_key(runner, 0x5, 0);
+    size_t lit = 0;
+    for (int frame = 0; frame < 200 && lit == 0; frame++) {
+        const uint8_t* display = NULL;
+        nanosleep(&frame_wait, NULL);
+        g2chip_runner_acquire_frame(runner, &display);
+        lit = count_frame_pixels(display);
+    }
+
+    g2chip_runner_destroy(runner);
+    CHECK(lit > 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+#define CAPTURE_TEST_FRAMES 600
+#define CAPTURE_TEST_PIXELS (G2CHIP_DISPLAY_WIDTH * G2CHIP_DISPLAY_HEIGHT)
+/*--------------------------------------------------------------------------------------------------------------------*/
+/** Blank, full, unchanged, partly changed and noisy frames, so every skip/run shape of the encoder is exercised */
+static void make_capture_frame(size_t frame, uint8_t* display) {
+    static uint32_t seed = 1;
+    if (frame == 0) {
+        seed = 1;
+        memset(display, 0, CAPTURE_TEST_PIXELS);
+    } else if (frame == 1) {
+        memset(display, 1, CAPTURE_TEST_PIXELS);
+    } else if (frame % 5 == 0) {
+        return;
+    } else {
+        size_t rows = (frame % 3 == 0) ? 3 : G2CHIP_DISPLAY_HEIGHT;
+        for (size_t row = 0; row < rows; row++) {
+            seed = seed * 1103515245u + 12345u;
+            size_t y = (rows == G2CHIP_DISPLAY_HEIGHT) ? row : (seed >> 16) % G2CHIP_DISPLAY_HEIGHT;
+            for (size_t x = 0; x < G2CHIP_DISPLAY_WIDTH; x++) {
+                seed = seed * 1103515245u + 12345u;
+                display[y * G2CHIP_DISPLAY_WIDTH + x] = (uint8_t)((seed >> 16) & 1);
+            }
+        }
+    }
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int check_capture_stream(const uint8_t* stream, size_t size) {
+    g2chip_capture_reader_t reader;
+    CHECK(g2chip_capture_reader_open(&reader, stream, size) == 0);
+
+    uint8_t expected[CAPTURE_TEST_PIXELS];
+    uint8_t decoded[CAPTURE_TEST_PIXELS];
+    for (size_t frame = 0; frame < CAPTURE_TEST_FRAMES; frame++) {
+        make_capture_frame(frame, expected);
+        CHECK(g2chip_capture_reader_next(&reader, decoded) == 1);
+        CHECK(memcmp(expected, decoded, sizeof(decoded)) == 0);
+    }
+    CHECK(g2chip_capture_reader_next(&reader, decoded) == 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_capture_round_trips_frames(void) {
+    g2chip_capture_t* capture = g2chip_capture_create();
+    CHECK(capture != NULL);
+
+    uint8_t display[CAPTURE_TEST_PIXELS];
+    int result = 0;
+    for (size_t frame = 0; frame < CAPTURE_TEST_FRAMES && result == 0; frame++) {
+        make_capture_frame(frame, display);
+        result = g2chip_capture_frame(capture, display);
+    }
+    size_t size = 0;
+    const uint8_t* stream = g2chip_capture_data(capture, &size);
+    if (result == 0) {
+        result = check_capture_stream(stream, size);
+    }
+    g2chip_capture_destroy(capture);
+    CHECK(result == 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static int test_capture_file_round_trips_frames(void) {
+    FILE* file = tmpfile();
+    CHECK(file != NULL);
+    g2chip_capture_t* capture = g2chip_capture_create_file(file);
+    if (capture == NULL) {
+        fclose(file);
+    }
+    CHECK(capture != NULL);
+
+    size_t unused = 0;
+    uint8_t display[CAPTURE_TEST_PIXELS];
+    int result = (g2chip_capture_data(capture, &unused) == NULL) ? 0 : -1;
+    for (size_t frame = 0; frame < CAPTURE_TEST_FRAMES && result == 0; frame++) {
+        make_capture_frame(frame, display);
+        result = g2chip_capture_frame(capture, display);
+    }
+    if (result == 0) {
+        result = g2chip_capture_flush(capture);
+    }
+    g2chip_capture_destroy(capture);
+
+    long size = ftell(file);
+    uint8_t* stream = (size > 0) ? (uint8_t*)malloc((size_t)size) : NULL;
+    rewind(file);
+    if (stream == NULL || fread(stream, 1, (size_t)size, file) != (size_t)size) {
+        result = -1;
+    }
+    fclose(file);
+    if (result == 0) {
+        result = check_capture_stream(stream, (size_t)size);
+    }
+    free(stream);
+    CHECK(result == 0);
+    return 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/
+static const test_case_t test_cases[] = {
+    {"shorter-rom-clears-previous", test_shorter_rom_clears_previous},
+    {"indirect-jump-writes-are-conservative", test_indirect_jump_writes_are_conservative},
+    {"invalid-opcode-writes-are-conservative", test_invalid_opcode_writes_are_conservative},
+    {"invalid-opcode-is-stepped-over", test_invalid_opcode_is_stepped_over},
+    {"unbalanced-return-writes-are-conservative", test_unbalanced_return_writes_are_conservative},
+    {"self-modifying-writes-are-conservative", test_self_modifying_writes_are_conservative},
+    {"held-key-satisfies-one-key-wait", test_held_key_satisfies_one_key_wait},
+    {"key-wait-polls-key-callback", test_key_wait_polls_key_callback},
+    {"runner-keeps-key-tap", test_runner_keeps_key_tap},
+    {"runner-keeps-consecutive-taps", test_runner_keeps_consecutive_taps},
+    {"corpus-cache-rejects-stale-records", test_corpus_cache_rejects_stale_records},
+    {"capture-round-trips-frames", test_capture_round_trips_frames},
+    {"capture-file-round-trips-frames", test_capture_file_round_trips_frames},
+};
+/*--------------------------------------------------------------------------------------------------------------------*/
+int main(int argc, char* argv[]) {
+    int result = 0;
+    for (size_t i = 0; i < sizeof(test_cases) / sizeof(test_cases[0]); i++) {
+        if (argc > 1 && strcmp(argv[1], test_cases[i].name) != 0) {
+            continue;
+        }
+        int failed = test_cases[i].run() != 0;
+        printf("%s: %s\n", test_cases[i].name, failed ? "FAILED" : "ok");
+        result |= failed;
+    }
+    return result ? -1 : 0;
+}
+/*--------------------------------------------------------------------------------------------------------------------*/